@@ -0,0 +1,290 @@
+/*****************************************************************************
+*
+*  Author:           Jesus Mendoza
+*  Email:            jesus.kyx.mendoza11@gmail.com
+*  Label:            Program 1 - Fraction Class
+*  Title:            Arbitrary-Precision Fraction Class
+*  Course:           CMPS 2143
+*  Semester:         Fall 2024
+*
+*  Description:
+*        A fraction whose numerator and denominator are BigInts, so it never
+*        overflows. It has the same interface as Fraction<T> (+ - * /, ==,
+*        operator<<, gcd/lcm/lcd) and is kept in lowest terms the same way.
+*
+*        Values under 2^128 stay inside the BigInts with no heap
+*        allocation. Long exact computations stay affordable because
+*        BigInt multiplies with Karatsuba and reduces with a
+*        subquadratic GCD (see bigint.hpp), and because the operators use
+*        Henrici's algorithms, which only take GCDs of the operands, never
+*        of the full result.
+*
+*  Usage:
+*        #include "big_fraction.hpp"
+*        BigFraction sum;
+*        for (int k = 1; k <= 1000; ++k)
+*            sum = sum + BigFraction(1, k);     // Harmonic number H(1000)
+*        BigFraction f(Fraction<long long>(3, 4));
+*
+*  Files:
+*        big_fraction.hpp  : This header.
+*        bigint.hpp        : The integer type.
+*        fraction.hpp      : Fixed-width Fraction<T>.
+*
+*****************************************************************************/
+
+#pragma once
+
+#include <iostream>
+#include <stdexcept>
+#include <utility>
+
+#include "bigint.hpp"
+#include "fraction.hpp"
+
+/**
+ * Class BigFraction
+ *
+ * Description:
+ *      An exact fraction of arbitrary size. It supports addition,
+ *      subtraction, multiplication, division and equality, and is always
+ *      stored in reduced form with a positive denominator.
+ *
+ * Public Methods:
+ *      - BigFraction(BigInt num = 0, BigInt den = 1)
+ *      - explicit BigFraction(const Fraction<T>& fraction)
+ *      - const BigInt& getNumerator() const
+ *      - const BigInt& getDenominator() const
+ *      - BigFraction operator+(const BigFraction& other) const
+ *      - BigFraction operator-(const BigFraction& other) const
+ *      - BigFraction operator*(const BigFraction& other) const
+ *      - BigFraction operator/(const BigFraction& other) const
+ *      - bool operator==(const BigFraction& other) const
+ *      - friend std::ostream& operator<<(std::ostream& os, const BigFraction& frac)
+ *      - static BigInt gcd(const BigInt& a, const BigInt& b)
+ *      - static BigInt lcm(const BigInt& a, const BigInt& b)
+ *      - static BigInt lcd(const BigInt& a, const BigInt& b)
+ *
+ * Private Methods:
+ *      - BigFraction(BigInt num, BigInt den, Reduced)
+ *      - void reduce()
+ *      - BigFraction sum(const BigFraction& other, bool subtract) const
+ *      - BigFraction product(const BigInt& num, const BigInt& den) const
+ */
+class BigFraction {
+private:
+    BigInt numerator;   // numerator of the fraction
+    BigInt denominator; // denominator of the fraction, always positive
+
+    // Tag for results that are already in lowest terms and skip reduce()
+    struct Reduced {};
+
+    BigFraction(BigInt num, BigInt den, Reduced) : numerator(std::move(num)), denominator(std::move(den)) {}
+
+    /**
+     * sum
+     *
+     * Description:
+     *      Henrici's addition, as in Fraction<T>: with g = gcd(b, d) the
+     *      result is t/g2 over (b/g)(d/g2), where t = a(d/g) ± c(b/g) and
+     *      g2 = gcd(t, g). Both GCDs are of numbers no larger than the
+     *      inputs, and the second is skipped when g is 1. In a long sum of
+     *      small fractions, g and g2 are small, so a step costs a few
+     *      products instead of a GCD of the full result.
+     */
+    BigFraction sum(const BigFraction& other, bool subtract) const {
+        BigInt g = gcd(denominator, other.denominator);
+        if (g == BigInt(1)) {
+            BigInt left = numerator * other.denominator;
+            BigInt right = other.numerator * denominator;
+            return BigFraction(subtract ? left - right : left + right, denominator * other.denominator, Reduced{});
+        }
+        BigInt left = other.denominator / g;  // Scales this fraction to the common denominator
+        BigInt right = denominator / g;       // Scales the other one
+        BigInt t = subtract ? numerator * left - other.numerator * right : numerator * left + other.numerator * right;
+        if (t.isZero())
+            return BigFraction();
+        BigInt g2 = gcd(t, g);
+        if (g2 == BigInt(1))
+            return BigFraction(std::move(t), right * other.denominator, Reduced{});
+        return BigFraction(t / g2, right * (other.denominator / g2), Reduced{});
+    }
+
+    /**
+     * product
+     *
+     * Description:
+     *      Henrici's multiplication by num/den (reduced, den of either sign):
+     *      cancels gcd(a, den) and gcd(num, b) before multiplying, so the
+     *      result needs no reduction.
+     */
+    BigFraction product(const BigInt& num, const BigInt& den) const {
+        if (numerator.isZero() || num.isZero())
+            return BigFraction();
+        BigInt g1 = gcd(numerator, den);
+        BigInt g2 = gcd(num, denominator);
+        BigInt n = (numerator / g1) * (num / g2);
+        BigInt d = (denominator / g2) * (den / g1);
+        if (d.isNegative()) {
+            n = -n;
+            d = -d;
+        }
+        return BigFraction(std::move(n), std::move(d), Reduced{});
+    }
+
+    /**
+     * reduce
+     *
+     * Description:
+     *      Reduces the fraction to its lowest terms using the GCD.
+     *      Ensures the denominator is always positive.
+     */
+    void reduce() {
+        BigInt gcd_val = gcd(numerator, denominator);
+        if (gcd_val != BigInt(1)) {
+            numerator /= gcd_val;
+            denominator /= gcd_val;
+        }
+        // Ensure the denominator is positive
+        if (denominator.isNegative()) {
+            numerator = -numerator;
+            denominator = -denominator;
+        }
+    }
+
+public:
+    /**
+     * BigFraction (Constructor)
+     *
+     * Description:
+     *      Constructs a fraction with a given numerator and denominator.
+     *      If the denominator is zero, it defaults to 1 to avoid division by zero.
+     */
+    BigFraction(BigInt num = 0, BigInt den = 1) : numerator(std::move(num)), denominator(std::move(den)) {
+        if (denominator.isZero()) {
+            std::cout << "Error: Denominator cannot be zero." << std::endl;
+            denominator = 1;  // Set a default valid denominator
+        }
+        reduce(); // Simplify the fraction
+    }
+
+    /**
+     * BigFraction (Converting Constructor)
+     *
+     * Description:
+     *      Converts a fixed-width fraction, which is already reduced.
+     */
+    template <typename T>
+    explicit BigFraction(const Fraction<T>& fraction)
+        : numerator(fraction.getNumerator()), denominator(fraction.getDenominator()) {}
+
+    const BigInt& getNumerator() const { return numerator; }
+    const BigInt& getDenominator() const { return denominator; }
+
+    /**
+     * operator+
+     *
+     * Description:
+     *      Overloads the addition operator to add two fractions.
+     *
+     * Returns:
+     *      BigFraction - the resulting fraction after addition
+     */
+    BigFraction operator+(const BigFraction& other) const { return sum(other, false); }
+
+    /**
+     * operator-
+     *
+     * Description:
+     *      Overloads the subtraction operator to subtract two fractions.
+     *
+     * Returns:
+     *      BigFraction - the resulting fraction after subtraction
+     */
+    BigFraction operator-(const BigFraction& other) const { return sum(other, true); }
+
+    /**
+     * operator*
+     *
+     * Description:
+     *      Overloads the multiplication operator to multiply two fractions.
+     *
+     * Returns:
+     *      BigFraction - the resulting fraction after multiplication
+     */
+    BigFraction operator*(const BigFraction& other) const { return product(other.numerator, other.denominator); }
+
+    /**
+     * operator/
+     *
+     * Description:
+     *      Overloads the division operator to divide two fractions.
+     *
+     * Returns:
+     *      BigFraction - the resulting fraction after division
+     *
+     * Throws:
+     *      invalid_argument - if division by zero is attempted
+     */
+    BigFraction operator/(const BigFraction& other) const {
+        if (other.numerator.isZero()) {
+            throw std::invalid_argument("Cannot divide by zero.");
+        }
+        return product(other.denominator, other.numerator);
+    }
+
+    /**
+     * operator==
+     *
+     * Description:
+     *      Overloads the equality operator to compare two fractions.
+     *
+     * Returns:
+     *      bool - true if the fractions are equal, false otherwise
+     */
+    bool operator==(const BigFraction& other) const {
+        return (numerator == other.numerator && denominator == other.denominator);
+    }
+
+    /**
+     * operator<<
+     *
+     * Description:
+     *      Overloads the output stream operator to print a fraction.
+     */
+    friend std::ostream& operator<<(std::ostream& os, const BigFraction& frac) {
+        os << frac.numerator << "/" << frac.denominator;
+        return os;
+    }
+
+    /**
+     * gcd
+     *
+     * Description:
+     *      Calculates the greatest common divisor (GCD) of two integers. The
+     *      result is never negative.
+     */
+    static BigInt gcd(const BigInt& a, const BigInt& b) { return BigInt::gcd(a, b); }
+
+    /**
+     * lcm
+     *
+     * Description:
+     *      Calculates the least common multiple (LCM) of two integers.
+     */
+    static BigInt lcm(const BigInt& a, const BigInt& b) {
+        if (a.isZero() || b.isZero())
+            return BigInt();
+        BigInt result = a / gcd(a, b) * b;
+        return result.isNegative() ? -result : result;
+    }
+
+    /**
+     * lcd
+     *
+     * Description:
+     *      Calculates the least common denominator (LCD) of two fractions,
+     *      which is the same as the LCM of their denominators.
+     */
+    static BigInt lcd(const BigInt& a, const BigInt& b) { return lcm(a, b); }
+};
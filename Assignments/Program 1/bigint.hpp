@@ -0,0 +1,1005 @@
+/*****************************************************************************
+*
+*  Author:           Jesus Mendoza
+*  Email:            jesus.kyx.mendoza11@gmail.com
+*  Label:            Program 1 - Fraction Class
+*  Title:            Arbitrary-Precision Integers
+*  Course:           CMPS 2143
+*  Semester:         Fall 2024
+*
+*  Description:
+*        A signed integer of any size, stored as a sign and a little-endian
+*        vector of 64-bit limbs. It is the number type behind BigFraction.
+*
+*        Storage: two limbs live inside the object, so any value under
+*        2^128 never touches the heap. Those values also take a fast path
+*        through unsigned __int128 arithmetic, so a BigFraction of small
+*        numbers costs little more than a Fraction<__int128>.
+*
+*        Multiplication: schoolbook below KARATSUBA_THRESHOLD limbs and
+*        Karatsuba above, which splits each operand in half and uses three
+*        half-size products instead of four (O(n^1.58) instead of O(n^2)).
+*
+*        Division: Knuth's Algorithm D, one 64-bit quotient limb per step.
+*
+*        GCD: Lehmer's algorithm below HGCD_THRESHOLD limbs. It runs
+*        Euclid's algorithm on the leading 62 bits of both numbers, which
+*        gives a 2x2 matrix of small cofactors, and then applies that matrix
+*        to the full numbers once, so each pass over the limbs removes about
+*        62 bits instead of one quotient. Above the threshold a half-GCD
+*        finds the matrix that halves the numbers recursively from their
+*        leading halves and applies it with fast multiplication, which makes
+*        the GCD subquadratic: O(M(n) log n), where M(n) is the cost of one
+*        multiplication.
+*
+*        Every matrix is a product of Euclid steps, so its determinant is
+*        +-1 and applying it keeps the GCD unchanged. A matrix built from
+*        leading bits is therefore always safe to use. At worst it removes
+*        fewer bits than it should, and the code then falls back to an
+*        ordinary division step.
+*
+*        Needs unsigned __int128 (GCC or Clang).
+*
+*  Usage:
+*        BigInt a("123456789012345678901234567890");
+*        BigInt b = a * a + 1;
+*        BigInt g = BigInt::gcd(a, b);
+*        std::cout << b << std::endl;
+*
+*  Files:
+*        bigint.hpp        : This header.
+*        big_fraction.hpp  : BigFraction, built on BigInt.
+*        gcd.hpp           : Kernels for GCDs of values up to 128 bits.
+*
+*****************************************************************************/
+
+#pragma once
+
+#include <algorithm>
+#include <compare>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "gcd.hpp"
+
+#ifndef __SIZEOF_INT128__
+#error "bigint.hpp needs unsigned __int128 (GCC or Clang)"
+#endif
+
+using Limb = std::uint64_t;
+using DoubleLimb = unsigned __int128;
+
+constexpr std::size_t KARATSUBA_THRESHOLD = 32;  // Limbs; below this schoolbook is faster
+// Limbs; below this Lehmer is faster. BigInt::gcd() times with the
+// half-GCD from 1024 limbs and with Lehmer only (threshold disabled):
+//
+//     limbs   half-GCD   Lehmer only
+//      1102    12.2 ms       9.1 ms
+//      1502    21.0 ms      16.6 ms
+//      2003    28.9 ms      28.9 ms
+//      4007    89   ms     115   ms
+//
+// A second machine, timing random pairs that share a factor a tenth of
+// their length (best of 25 runs), put the crossover at 3000-4000 limbs.
+constexpr std::size_t HGCD_THRESHOLD = 3072;
+constexpr std::size_t HGCD_BASE_THRESHOLD = 128; // Limbs; the half-GCD recursion stops here
+
+// ---------------------------------------------------------------------
+// Limb array routines. Arrays are little-endian; "trimmed" means the top
+// limb is not zero.
+// ---------------------------------------------------------------------
+
+// Compares two trimmed magnitudes: negative, zero or positive
+inline int limbCompare(const Limb* a, std::size_t an, const Limb* b, std::size_t bn) {
+    if (an != bn)
+        return an < bn ? -1 : 1;
+    for (std::size_t i = an; i-- > 0;)
+        if (a[i] != b[i])
+            return a[i] < b[i] ? -1 : 1;
+    return 0;
+}
+
+// out = a + b for an >= bn, writing an limbs; returns the carry. out may
+// be a or b.
+inline Limb limbAdd(Limb* out, const Limb* a, std::size_t an, const Limb* b, std::size_t bn) {
+    Limb carry = 0;
+    for (std::size_t i = 0; i < bn; ++i) {
+        DoubleLimb sum = static_cast<DoubleLimb>(a[i]) + b[i] + carry;
+        out[i] = static_cast<Limb>(sum);
+        carry = static_cast<Limb>(sum >> 64);
+    }
+    for (std::size_t i = bn; i < an; ++i) {
+        Limb sum = a[i] + carry;
+        carry = sum < carry;
+        out[i] = sum;
+    }
+    return carry;
+}
+
+// out = a - b for a >= b and an >= bn, writing an limbs; returns the
+// borrow (0 when a >= b). out may be a or b.
+inline Limb limbSub(Limb* out, const Limb* a, std::size_t an, const Limb* b, std::size_t bn) {
+    Limb borrow = 0;
+    for (std::size_t i = 0; i < bn; ++i) {
+        Limb x = a[i];
+        Limb diff = x - b[i];
+        Limb borrowOut = x < b[i];
+        out[i] = diff - borrow;
+        borrow = borrowOut | (diff < borrow);
+    }
+    for (std::size_t i = bn; i < an; ++i) {
+        Limb x = a[i];
+        out[i] = x - borrow;
+        borrow = x < borrow;
+    }
+    return borrow;
+}
+
+// out[0..n) += a[0..n) * m; returns the carry out of the top limb
+inline Limb limbMulAdd(Limb* out, const Limb* a, std::size_t n, Limb m) {
+    Limb carry = 0;
+    for (std::size_t i = 0; i < n; ++i) {
+        DoubleLimb product = static_cast<DoubleLimb>(a[i]) * m + out[i] + carry;
+        out[i] = static_cast<Limb>(product);
+        carry = static_cast<Limb>(product >> 64);
+    }
+    return carry;
+}
+
+// out[0..an+bn) = a * b by the schoolbook method; out must not overlap
+inline void limbMulSchool(Limb* out, const Limb* a, std::size_t an, const Limb* b, std::size_t bn) {
+    std::fill(out, out + an + bn, Limb(0));
+    for (std::size_t i = 0; i < bn; ++i)
+        out[i + an] = limbMulAdd(out + i, a, an, b[i]);
+}
+
+// out[0..2n) = a * b for two n-limb numbers by Karatsuba's method
+inline void limbKaratsuba(Limb* out, const Limb* a, const Limb* b, std::size_t n) {
+    if (n < KARATSUBA_THRESHOLD) {
+        limbMulSchool(out, a, n, b, n);
+        return;
+    }
+    // a = a1 * B^low + a0 and b = b1 * B^low + b0, then
+    // a * b = z2 * B^(2 low) + (z1 - z2 - z0) * B^low + z0 with
+    // z0 = a0 b0, z2 = a1 b1, z1 = (a0 + a1)(b0 + b1)
+    std::size_t low = n / 2;
+    std::size_t high = n - low;
+    limbKaratsuba(out, a, b, low);
+    limbKaratsuba(out + 2 * low, a + low, b + low, high);
+
+    std::vector<Limb> sumA(high + 1), sumB(high + 1), middle(2 * high + 2);
+    sumA[high] = limbAdd(sumA.data(), a + low, high, a, low);
+    sumB[high] = limbAdd(sumB.data(), b + low, high, b, low);
+    limbKaratsuba(middle.data(), sumA.data(), sumB.data(), high + 1);
+    limbSub(middle.data(), middle.data(), middle.size(), out, 2 * low);
+    limbSub(middle.data(), middle.data(), middle.size(), out + 2 * low, 2 * high);
+
+    std::size_t used = middle.size();
+    while (used > 0 && middle[used - 1] == 0)
+        --used;
+    limbAdd(out + low, out + low, low + 2 * high, middle.data(), used);
+}
+
+// out[0..an+bn) = a * b; out must not overlap a or b
+inline void limbMul(Limb* out, const Limb* a, std::size_t an, const Limb* b, std::size_t bn) {
+    if (an < bn) {
+        std::swap(a, b);
+        std::swap(an, bn);
+    }
+    if (bn < KARATSUBA_THRESHOLD) {
+        limbMulSchool(out, a, an, b, bn);
+    } else if (an == bn) {
+        limbKaratsuba(out, a, b, an);
+    } else {
+        // Unbalanced: multiply b by bn-limb slices of a and add them up
+        std::fill(out, out + an + bn, Limb(0));
+        std::vector<Limb> slice(2 * bn);
+        for (std::size_t offset = 0; offset < an; offset += bn) {
+            std::size_t length = std::min(bn, an - offset);
+            limbMul(slice.data(), a + offset, length, b, bn);
+            limbAdd(out + offset, out + offset, an + bn - offset, slice.data(), length + bn);
+        }
+    }
+}
+
+// quotient[0..n) = a / d, returning a % d; quotient may be a
+inline Limb limbDivLimb(Limb* quotient, const Limb* a, std::size_t n, Limb d) {
+    DoubleLimb remainder = 0;
+    for (std::size_t i = n; i-- > 0;) {
+        DoubleLimb current = remainder << 64 | a[i];
+        quotient[i] = static_cast<Limb>(current / d);
+        remainder = current % d;
+    }
+    return static_cast<Limb>(remainder);
+}
+
+// Knuth's Algorithm D for an >= bn >= 2 and a trimmed divisor:
+// quotient gets an - bn + 1 limbs and remainder (if not null) bn limbs
+inline void limbDivMod(Limb* quotient, Limb* remainder, const Limb* a, std::size_t an, const Limb* b,
+                       std::size_t bn) {
+    // Normalize so the divisor's top bit is set, which keeps each trial
+    // quotient within two of the true one
+    int shift = __builtin_clzll(b[bn - 1]);
+    std::vector<Limb> v(bn), u(an + 1);
+    for (std::size_t i = bn; i-- > 1;)
+        v[i] = b[i] << shift | (shift ? b[i - 1] >> (64 - shift) : 0);
+    v[0] = b[0] << shift;
+    u[an] = shift ? a[an - 1] >> (64 - shift) : 0;
+    for (std::size_t i = an; i-- > 1;)
+        u[i] = a[i] << shift | (shift ? a[i - 1] >> (64 - shift) : 0);
+    u[0] = a[0] << shift;
+
+    for (std::size_t j = an - bn + 1; j-- > 0;) {
+        DoubleLimb top = static_cast<DoubleLimb>(u[j + bn]) << 64 | u[j + bn - 1];
+        DoubleLimb qhat = top / v[bn - 1];
+        DoubleLimb rhat = top % v[bn - 1];
+        while (qhat >> 64 || qhat * v[bn - 2] > (rhat << 64 | u[j + bn - 2])) {
+            --qhat;
+            rhat += v[bn - 1];
+            if (rhat >> 64)
+                break;
+        }
+
+        // u[j..j+bn] -= qhat * v
+        Limb borrow = 0;
+        Limb carry = 0;
+        for (std::size_t i = 0; i < bn; ++i) {
+            DoubleLimb product = qhat * v[i] + carry;
+            carry = static_cast<Limb>(product >> 64);
+            Limb x = u[i + j];
+            Limb diff = x - static_cast<Limb>(product);
+            Limb borrowOut = x < static_cast<Limb>(product);
+            u[i + j] = diff - borrow;
+            borrow = borrowOut | (diff < borrow);
+        }
+        Limb x = u[j + bn];
+        Limb diff = x - carry;
+        bool negative = x < carry || diff < borrow;
+        u[j + bn] = diff - borrow;
+
+        // qhat was one too large: add the divisor back
+        if (negative) {
+            --qhat;
+            Limb addCarry = limbAdd(u.data() + j, u.data() + j, bn, v.data(), bn);
+            u[j + bn] += addCarry;
+        }
+        quotient[j] = static_cast<Limb>(qhat);
+    }
+
+    if (remainder)
+        for (std::size_t i = 0; i < bn; ++i)
+            remainder[i] = u[i] >> shift | (shift ? u[i + 1] << (64 - shift) : 0);
+}
+
+/**
+ * Class BigInt
+ *
+ * Description:
+ *      A signed arbitrary-precision integer. Values under 2^128 are kept
+ *      inside the object; larger ones on the heap. Division truncates toward
+ *      zero like the built-in integers, so a % b has the sign of a.
+ *
+ * Public Methods:
+ *      - BigInt(T value)                         (any built-in integer or __int128)
+ *      - explicit BigInt(const std::string& text)
+ *      - bool isZero() const
+ *      - bool isNegative() const
+ *      - int sign() const
+ *      - std::size_t limbCount() const
+ *      - std::size_t bitLength() const
+ *      - bool fitsInt128() const
+ *      - __int128 toInt128() const
+ *      - std::string toString() const
+ *      - BigInt operator-() const
+ *      - BigInt operator+, -, *, /, % (const BigInt&, const BigInt&)
+ *      - BigInt& operator+=, -=, *=, /=, %=
+ *      - BigInt operator<<(std::size_t bits) const, operator>>(std::size_t bits) const
+ *      - bool operator==, std::strong_ordering operator<=>
+ *      - friend std::ostream& operator<<(std::ostream& os, const BigInt& value)
+ *      - static void divMod(const BigInt& a, const BigInt& b, BigInt& quotient, BigInt& remainder)
+ *      - static BigInt gcd(BigInt a, BigInt b)
+ *
+ * Private Methods:
+ *      - void reserve(std::size_t count)
+ *      - void trim()
+ *      - static void addSigned(BigInt& out, const BigInt& a, const BigInt& b, bool subtract)
+ *      - static void lehmerStep(BigInt& a, BigInt& b, BigInt& spareA, BigInt& spareB)
+ *      - static bool halfGcd(const BigInt& a, const BigInt& b, Matrix& m)
+ */
+class BigInt {
+public:
+    static constexpr std::size_t INLINE_LIMBS = 2;  // 128 bits without the heap
+
+private:
+    Limb* limbs;              // inlineLimbs or a heap array
+    std::uint32_t length;     // Limbs in use; the top one is never zero
+    std::uint32_t capacity;
+    bool negative;
+    Limb inlineLimbs[INLINE_LIMBS];
+
+    bool onHeap() const { return limbs != inlineLimbs; }
+
+    // Makes room for count limbs, keeping the ones in use
+    void reserve(std::size_t count) {
+        if (count <= capacity)
+            return;
+        std::size_t grown = std::max<std::size_t>(count, capacity + capacity / 2);
+        Limb* fresh = new Limb[grown];
+        std::copy(limbs, limbs + length, fresh);
+        if (onHeap())
+            delete[] limbs;
+        limbs = fresh;
+        capacity = static_cast<std::uint32_t>(grown);
+    }
+
+    // Sets the length to count limbs, zeroing any new ones
+    void resize(std::size_t count) {
+        reserve(count);
+        if (count > length)
+            std::fill(limbs + length, limbs + count, Limb(0));
+        length = static_cast<std::uint32_t>(count);
+    }
+
+    // Drops leading zero limbs; zero is never negative
+    void trim() {
+        while (length > 0 && limbs[length - 1] == 0)
+            --length;
+        if (length == 0)
+            negative = false;
+    }
+
+    void setMagnitude(DoubleLimb magnitude) {
+        limbs[0] = static_cast<Limb>(magnitude);
+        limbs[1] = static_cast<Limb>(magnitude >> 64);
+        length = 2;
+        trim();
+    }
+
+    // Magnitude of a value of at most two limbs
+    DoubleLimb smallMagnitude() const {
+        DoubleLimb value = 0;
+        if (length > 1)
+            value = static_cast<DoubleLimb>(limbs[1]) << 64;
+        if (length > 0)
+            value |= limbs[0];
+        return value;
+    }
+
+    // Up to 64 bits of the magnitude starting at bit shift
+    Limb bitsAt(std::size_t shift) const {
+        std::size_t index = shift / 64;
+        unsigned offset = static_cast<unsigned>(shift % 64);
+        if (index >= length)
+            return 0;
+        Limb value = limbs[index] >> offset;
+        if (offset && index + 1 < length)
+            value |= limbs[index + 1] << (64 - offset);
+        return value;
+    }
+
+    // out = a + b, or a - b if subtract; out may be a or b
+    static void addSigned(BigInt& out, const BigInt& a, const BigInt& b, bool subtract) {
+        bool bNegative = b.negative != subtract;
+        if (a.length <= INLINE_LIMBS && b.length <= INLINE_LIMBS) {
+            DoubleLimb x = a.smallMagnitude();
+            DoubleLimb y = b.smallMagnitude();
+            if (a.negative == bNegative) {
+                DoubleLimb sum;
+                if (!__builtin_add_overflow(x, y, &sum)) {
+                    out.negative = a.negative;
+                    out.setMagnitude(sum);
+                    return;
+                }
+            } else {
+                out.negative = x >= y ? a.negative : bNegative;
+                out.setMagnitude(x >= y ? x - y : y - x);
+                return;
+            }
+        }
+
+        if (a.negative == bNegative) {
+            bool aLonger = a.length >= b.length;
+            std::size_t longLength = aLonger ? a.length : b.length;
+            std::size_t shortLength = aLonger ? b.length : a.length;
+            out.reserve(longLength + 1);  // a and b are read through their objects after this
+            const Limb* longLimbs = aLonger ? a.limbs : b.limbs;
+            const Limb* shortLimbs = aLonger ? b.limbs : a.limbs;
+            Limb carry = limbAdd(out.limbs, longLimbs, longLength, shortLimbs, shortLength);
+            out.limbs[longLength] = carry;
+            out.length = static_cast<std::uint32_t>(longLength + 1);
+            out.negative = a.negative;
+        } else {
+            int order = limbCompare(a.limbs, a.length, b.limbs, b.length);
+            bool aLarger = order >= 0;
+            std::size_t largeLength = aLarger ? a.length : b.length;
+            std::size_t smallLength = aLarger ? b.length : a.length;
+            out.reserve(largeLength);
+            const Limb* largeLimbs = aLarger ? a.limbs : b.limbs;
+            const Limb* smallLimbs = aLarger ? b.limbs : a.limbs;
+            limbSub(out.limbs, largeLimbs, largeLength, smallLimbs, smallLength);
+            out.length = static_cast<std::uint32_t>(largeLength);
+            out.negative = aLarger ? a.negative : bNegative;
+        }
+        out.trim();
+    }
+
+    // Euclid's algorithm on the leading 62 bits of a >= b: fills p, q, r,
+    // s so that (p a + q b, r a + s b) continues the remainder sequence
+    // of (a, b), and returns false if not even one step could be trusted
+    static bool lehmerCofactors(const BigInt& a, const BigInt& b, std::int64_t& p, std::int64_t& q,
+                                std::int64_t& r, std::int64_t& s) {
+        // 62 bits leave room for the cofactors, so everything fits int64
+        std::size_t bits = a.bitLength();
+        std::size_t shift = bits > 62 ? bits - 62 : 0;
+        constexpr Limb MASK = (Limb(1) << 62) - 1;
+        std::int64_t x = static_cast<std::int64_t>(a.bitsAt(shift) & MASK);
+        std::int64_t y = static_cast<std::int64_t>(b.bitsAt(shift) & MASK);
+        std::int64_t A = 1, B = 0, C = 0, D = 1;
+
+        // Collins' test: a quotient of the truncated numbers is only used
+        // if both ways of rounding the cofactors agree on it
+        while (y + C != 0 && y + D != 0) {
+            std::int64_t quotient = (x + A) / (y + C);
+            if (quotient != (x + B) / (y + D))
+                break;
+            std::int64_t t = A - quotient * C;
+            A = C;
+            C = t;
+            t = B - quotient * D;
+            B = D;
+            D = t;
+            t = x - quotient * y;
+            x = y;
+            y = t;
+        }
+        p = A;
+        q = B;
+        r = C;
+        s = D;
+        return B != 0;
+    }
+
+    // One division step: (a, b) = (b, a mod b)
+    static void divisionStep(BigInt& a, BigInt& b) {
+        BigInt quotient, remainder;
+        divMod(a, b, quotient, remainder);
+        a = std::move(b);
+        b = std::move(remainder);
+    }
+
+    // (outA, outB) = (p a + q b, r a + s b) for a >= b and cofactors from
+    // lehmerCofactors(), whose results are never negative. Both rows are
+    // built in one pass with signed 128-bit carries, so no sign cases are
+    // needed: each product is under 2^126 and the two in a row have
+    // opposite signs.
+    static void applyCofactors(BigInt& outA, BigInt& outB, const BigInt& a, const BigInt& b, std::int64_t p,
+                               std::int64_t q, std::int64_t r, std::int64_t s) {
+        std::size_t n = a.length;
+        outA.reserve(n);
+        outB.reserve(n);
+        __int128 carryA = 0, carryB = 0;
+        std::size_t i = 0;
+        for (; i < b.length; ++i) {
+            __int128 x = a.limbs[i];
+            __int128 y = b.limbs[i];
+            __int128 rowA = p * x + q * y + carryA;
+            __int128 rowB = r * x + s * y + carryB;
+            outA.limbs[i] = static_cast<Limb>(rowA);
+            outB.limbs[i] = static_cast<Limb>(rowB);
+            carryA = rowA >> 64;
+            carryB = rowB >> 64;
+        }
+        for (; i < n; ++i) {
+            __int128 x = a.limbs[i];
+            __int128 rowA = p * x + carryA;
+            __int128 rowB = r * x + carryB;
+            outA.limbs[i] = static_cast<Limb>(rowA);
+            outB.limbs[i] = static_cast<Limb>(rowB);
+            carryA = rowA >> 64;
+            carryB = rowB >> 64;
+        }
+        outA.length = outB.length = static_cast<std::uint32_t>(n);
+        outA.negative = outB.negative = false;
+        outA.trim();
+        outB.trim();
+    }
+
+    // Moves (a, b) along the remainder sequence by up to 62 bits
+    static void lehmerStep(BigInt& a, BigInt& b, BigInt& spareA, BigInt& spareB) {
+        std::int64_t p, q, r, s;
+        if (b.bitLength() + 32 < a.bitLength() || !lehmerCofactors(a, b, p, q, r, s)) {
+            divisionStep(a, b);
+            return;
+        }
+        applyCofactors(spareA, spareB, a, b, p, q, r, s);
+        std::swap(a, spareA);
+        std::swap(b, spareB);
+    }
+
+    struct Matrix;
+    static void reduceTo(BigInt& a, BigInt& b, std::size_t stop, Matrix& m);
+    static void normalizePair(BigInt& a, BigInt& b, Matrix& m);
+    static bool halfGcd(const BigInt& a, const BigInt& b, Matrix& m);
+
+    static void gcdSmall(DoubleLimb& a, DoubleLimb b) { a = GcdEngine<DoubleLimb>::gcd(a, b); }
+
+public:
+    BigInt() : limbs(inlineLimbs), length(0), capacity(INLINE_LIMBS), negative(false) {}
+
+    template <typename T>
+        requires(std::is_integral_v<T> || std::is_same_v<T, __int128> || std::is_same_v<T, unsigned __int128>)
+    BigInt(T value) : BigInt() {
+        negative = value < 0;
+        if constexpr (sizeof(T) <= sizeof(Limb)) {
+            Limb magnitude = negative ? Limb(0) - static_cast<Limb>(value) : static_cast<Limb>(value);
+            limbs[0] = magnitude;
+            length = magnitude != 0;
+        } else {
+            setMagnitude(negative ? DoubleLimb(0) - static_cast<DoubleLimb>(value) : static_cast<DoubleLimb>(value));
+        }
+    }
+
+    /**
+     * BigInt (Constructor)
+     *
+     * Description:
+     *      Parses a decimal number with an optional leading minus sign.
+     *
+     * Throws:
+     *      invalid_argument - if the text is not a decimal integer
+     */
+    explicit BigInt(const std::string& text) : BigInt() {
+        std::size_t start = !text.empty() && (text[0] == '-' || text[0] == '+');
+        if (start == text.size())
+            throw std::invalid_argument("Not an integer: \"" + text + "\"");
+        // 19 digits at a time: multiply by 10^k and add the chunk
+        for (std::size_t i = start; i < text.size();) {
+            std::size_t count = std::min<std::size_t>(19, text.size() - i);
+            Limb chunk = 0;
+            Limb scale = 1;
+            for (std::size_t k = 0; k < count; ++k, ++i) {
+                if (text[i] < '0' || text[i] > '9')
+                    throw std::invalid_argument("Not an integer: \"" + text + "\"");
+                chunk = chunk * 10 + static_cast<Limb>(text[i] - '0');
+                scale *= 10;
+            }
+            reserve(length + 1);
+            Limb carry = chunk;
+            for (std::size_t k = 0; k < length; ++k) {
+                DoubleLimb product = static_cast<DoubleLimb>(limbs[k]) * scale + carry;
+                limbs[k] = static_cast<Limb>(product);
+                carry = static_cast<Limb>(product >> 64);
+            }
+            if (carry)
+                limbs[length++] = carry;
+        }
+        negative = text[0] == '-';
+        trim();
+    }
+
+    BigInt(const BigInt& other) : BigInt() {
+        reserve(other.length);
+        std::copy(other.limbs, other.limbs + other.length, limbs);
+        length = other.length;
+        negative = other.negative;
+    }
+
+    BigInt(BigInt&& other) noexcept : BigInt() { *this = std::move(other); }
+
+    BigInt& operator=(const BigInt& other) {
+        if (this != &other) {
+            reserve(other.length);
+            std::copy(other.limbs, other.limbs + other.length, limbs);
+            length = other.length;
+            negative = other.negative;
+        }
+        return *this;
+    }
+
+    BigInt& operator=(BigInt&& other) noexcept {
+        if (this == &other)
+            return *this;
+        if (other.onHeap()) {
+            if (onHeap())
+                delete[] limbs;
+            limbs = other.limbs;
+            capacity = other.capacity;
+            other.limbs = other.inlineLimbs;
+            other.capacity = INLINE_LIMBS;
+        } else {
+            // Inline values are copied; a heap array already here is reused
+            std::copy(other.limbs, other.limbs + other.length, limbs);
+        }
+        length = other.length;
+        negative = other.negative;
+        other.length = 0;
+        other.negative = false;
+        return *this;
+    }
+
+    ~BigInt() {
+        if (onHeap())
+            delete[] limbs;
+    }
+
+    bool isZero() const { return length == 0; }
+    bool isNegative() const { return negative; }
+    int sign() const { return negative ? -1 : length > 0; }
+    std::size_t limbCount() const { return length; }
+
+    std::size_t bitLength() const {
+        return length == 0 ? 0 : 64 * length - static_cast<std::size_t>(__builtin_clzll(limbs[length - 1]));
+    }
+
+    // True if the value fits in a signed __int128
+    bool fitsInt128() const {
+        if (length < 2)
+            return true;
+        if (length > 2)
+            return false;
+        DoubleLimb magnitude = smallMagnitude();
+        return magnitude >> 127 == 0 || (negative && magnitude == DoubleLimb(1) << 127);
+    }
+
+    __int128 toInt128() const {
+        if (!fitsInt128())
+            throw std::overflow_error("BigInt does not fit in 128 bits");
+        DoubleLimb magnitude = smallMagnitude();
+        return static_cast<__int128>(negative ? DoubleLimb(0) - magnitude : magnitude);
+    }
+
+    std::string toString() const {
+        std::string digits;
+        if (length <= INLINE_LIMBS) {
+            DoubleLimb magnitude = smallMagnitude();
+            do {
+                digits += static_cast<char>('0' + static_cast<int>(magnitude % 10));
+                magnitude /= 10;
+            } while (magnitude != 0);
+        } else {
+            // Peel off 19 digits at a time with one-limb divisions
+            constexpr Limb CHUNK = 10000000000000000000ull;
+            std::vector<Limb> rest(limbs, limbs + length);
+            std::size_t used = rest.size();
+            while (used > 0) {
+                Limb chunk = limbDivLimb(rest.data(), rest.data(), used, CHUNK);
+                while (used > 0 && rest[used - 1] == 0)
+                    --used;
+                for (int k = 0; k < 19 && (used > 0 || chunk != 0); ++k) {
+                    digits += static_cast<char>('0' + chunk % 10);
+                    chunk /= 10;
+                }
+            }
+        }
+        if (negative)
+            digits += '-';
+        std::reverse(digits.begin(), digits.end());
+        return digits;
+    }
+
+    BigInt operator-() const {
+        BigInt result = *this;
+        if (!result.isZero())
+            result.negative = !negative;
+        return result;
+    }
+
+    BigInt& operator+=(const BigInt& other) {
+        addSigned(*this, *this, other, false);
+        return *this;
+    }
+
+    BigInt& operator-=(const BigInt& other) {
+        addSigned(*this, *this, other, true);
+        return *this;
+    }
+
+    friend BigInt operator+(const BigInt& a, const BigInt& b) {
+        BigInt result;
+        addSigned(result, a, b, false);
+        return result;
+    }
+
+    friend BigInt operator-(const BigInt& a, const BigInt& b) {
+        BigInt result;
+        addSigned(result, a, b, true);
+        return result;
+    }
+
+    friend BigInt operator*(const BigInt& a, const BigInt& b) {
+        BigInt result;
+        if (a.isZero() || b.isZero())
+            return result;
+        result.negative = a.negative != b.negative;
+        if (a.length <= INLINE_LIMBS && b.length <= INLINE_LIMBS) {
+            DoubleLimb product;
+            if (!__builtin_mul_overflow(a.smallMagnitude(), b.smallMagnitude(), &product)) {
+                result.setMagnitude(product);
+                return result;
+            }
+        }
+        result.resize(a.length + b.length);
+        limbMul(result.limbs, a.limbs, a.length, b.limbs, b.length);
+        result.trim();
+        return result;
+    }
+
+    BigInt& operator*=(const BigInt& other) { return *this = *this * other; }
+
+    /**
+     * divMod
+     *
+     * Description:
+     *      Divides a by b, truncating toward zero, so that
+     *      a == quotient * b + remainder and the remainder has a's sign.
+     *
+     * Throws:
+     *      invalid_argument - if b is zero
+     */
+    static void divMod(const BigInt& a, const BigInt& b, BigInt& quotient, BigInt& remainder) {
+        if (b.isZero())
+            throw std::invalid_argument("Cannot divide by zero.");
+        bool quotientNegative = a.negative != b.negative;
+        bool remainderNegative = a.negative;
+        if (limbCompare(a.limbs, a.length, b.limbs, b.length) < 0) {
+            remainder = a;
+            quotient = BigInt();
+            return;
+        }
+        if (a.length <= INLINE_LIMBS) {
+            DoubleLimb x = a.smallMagnitude();
+            DoubleLimb y = b.smallMagnitude();
+            quotient.setMagnitude(x / y);
+            remainder.setMagnitude(x % y);
+        } else if (b.length == 1) {
+            BigInt q;
+            q.resize(a.length);
+            Limb r = limbDivLimb(q.limbs, a.limbs, a.length, b.limbs[0]);
+            q.trim();
+            quotient = std::move(q);
+            remainder = BigInt(r);
+        } else {
+            BigInt q, r;
+            q.resize(a.length - b.length + 1);
+            r.resize(b.length);
+            limbDivMod(q.limbs, r.limbs, a.limbs, a.length, b.limbs, b.length);
+            q.trim();
+            r.trim();
+            quotient = std::move(q);
+            remainder = std::move(r);
+        }
+        quotient.negative = quotientNegative && !quotient.isZero();
+        remainder.negative = remainderNegative && !remainder.isZero();
+    }
+
+    friend BigInt operator/(const BigInt& a, const BigInt& b) {
+        BigInt quotient, remainder;
+        divMod(a, b, quotient, remainder);
+        return quotient;
+    }
+
+    friend BigInt operator%(const BigInt& a, const BigInt& b) {
+        BigInt quotient, remainder;
+        divMod(a, b, quotient, remainder);
+        return remainder;
+    }
+
+    BigInt& operator/=(const BigInt& other) { return *this = *this / other; }
+    BigInt& operator%=(const BigInt& other) { return *this = *this % other; }
+
+    // Shifts the magnitude left; the sign is kept
+    BigInt operator<<(std::size_t bits) const {
+        BigInt result;
+        if (isZero())
+            return result;
+        std::size_t whole = bits / 64;
+        unsigned offset = static_cast<unsigned>(bits % 64);
+        result.resize(length + whole + 1);
+        for (std::size_t i = 0; i < length; ++i) {
+            result.limbs[i + whole] |= limbs[i] << offset;
+            if (offset)
+                result.limbs[i + whole + 1] = limbs[i] >> (64 - offset);
+        }
+        result.negative = negative;
+        result.trim();
+        return result;
+    }
+
+    // Shifts the magnitude right, dropping low bits; the sign is kept
+    BigInt operator>>(std::size_t bits) const {
+        BigInt result;
+        std::size_t whole = bits / 64;
+        if (whole >= length)
+            return result;
+        result.resize(length - whole);
+        for (std::size_t i = 0; i < result.length; ++i)
+            result.limbs[i] = bitsAt(bits + 64 * i);
+        result.negative = negative;
+        result.trim();
+        return result;
+    }
+
+    friend bool operator==(const BigInt& a, const BigInt& b) {
+        return a.negative == b.negative && limbCompare(a.limbs, a.length, b.limbs, b.length) == 0;
+    }
+
+    friend std::strong_ordering operator<=>(const BigInt& a, const BigInt& b) {
+        if (a.negative != b.negative)
+            return a.negative ? std::strong_ordering::less : std::strong_ordering::greater;
+        int order = limbCompare(a.limbs, a.length, b.limbs, b.length);
+        if (a.negative)
+            order = -order;
+        return order < 0 ? std::strong_ordering::less
+                         : order > 0 ? std::strong_ordering::greater : std::strong_ordering::equal;
+    }
+
+    friend std::ostream& operator<<(std::ostream& os, const BigInt& value) { return os << value.toString(); }
+
+    /**
+     * gcd
+     *
+     * Description:
+     *      Greatest common divisor of |a| and |b| (gcd(0, 0) is 0). Uses the
+     *      binary method under 2^128, Lehmer's algorithm up to
+     *      HGCD_THRESHOLD limbs, and the half-GCD above it.
+     *
+     * Returns:
+     *      BigInt - the GCD, never negative
+     */
+    static BigInt gcd(BigInt a, BigInt b);
+};
+
+// Two-by-two matrix of cofactors: (a', b') = m * (a, b)
+struct BigInt::Matrix {
+    BigInt m[2][2] = {{1, 0}, {0, 1}};
+
+    // this = [[p, q], [r, s]] * this
+    void leftMultiply(const BigInt& p, const BigInt& q, const BigInt& r, const BigInt& s) {
+        for (int col = 0; col < 2; ++col) {
+            BigInt top = p * m[0][col] + q * m[1][col];
+            m[1][col] = r * m[0][col] + s * m[1][col];
+            m[0][col] = std::move(top);
+        }
+    }
+
+    // this = other * this
+    void leftMultiply(const Matrix& other) {
+        leftMultiply(other.m[0][0], other.m[0][1], other.m[1][0], other.m[1][1]);
+    }
+
+    // (a, b) = this * (a, b)
+    void apply(BigInt& a, BigInt& b) const {
+        BigInt top = m[0][0] * a + m[0][1] * b;
+        b = m[1][0] * a + m[1][1] * b;
+        a = std::move(top);
+    }
+};
+
+// Runs the remainder sequence of a >= b while the smaller number keeps
+// more than stop bits, recording every step in m
+inline void BigInt::reduceTo(BigInt& a, BigInt& b, std::size_t stop, Matrix& m) {
+    BigInt spareA, spareB;
+    while (b.bitLength() > stop) {
+        std::int64_t p, q, r, s;
+        if (b.bitLength() + 32 >= a.bitLength() && lehmerCofactors(a, b, p, q, r, s)) {
+            applyCofactors(spareA, spareB, a, b, p, q, r, s);
+            if (spareB.bitLength() > stop) {
+                std::swap(a, spareA);
+                std::swap(b, spareB);
+                m.leftMultiply(BigInt(p), BigInt(q), BigInt(r), BigInt(s));
+                continue;
+            }
+        }
+        // Single quotient, so the sequence stops exactly at stop bits
+        BigInt quotient, remainder;
+        divMod(a, b, quotient, remainder);
+        if (remainder.bitLength() <= stop)
+            break;
+        a = std::move(b);
+        b = std::move(remainder);
+        m.leftMultiply(BigInt(0), BigInt(1), BigInt(1), -quotient);
+    }
+}
+
+// Puts (a, b) back in order after a matrix from leading bits was
+// applied: both non-negative and a >= b. Negating or swapping rows
+// keeps the determinant +-1, so the GCD is unchanged.
+inline void BigInt::normalizePair(BigInt& a, BigInt& b, Matrix& m) {
+    if (a.negative) {
+        a.negative = false;
+        m.m[0][0] = -m.m[0][0];
+        m.m[0][1] = -m.m[0][1];
+    }
+    if (b.negative) {
+        b.negative = false;
+        m.m[1][0] = -m.m[1][0];
+        m.m[1][1] = -m.m[1][1];
+    }
+    if (a < b) {
+        std::swap(a, b);
+        std::swap(m.m[0], m.m[1]);
+    }
+}
+
+/**
+ * halfGcd
+ *
+ * Description:
+ *      Finds a matrix that moves a >= b > 0 along its remainder sequence
+ *      until the smaller number has about half of a's bits, working
+ *      recursively from leading halves: the first half of the quotients
+ *      depends only on the leading half of the bits. Below
+ *      HGCD_BASE_THRESHOLD limbs it takes Lehmer steps instead. The cost
+ *      is O(M(n) log n).
+ *
+ * Returns:
+ *      bool - false if no step was taken
+ */
+inline bool BigInt::halfGcd(const BigInt& a0, const BigInt& b0, Matrix& m) {
+    std::size_t bits = a0.bitLength();
+    std::size_t stop = bits / 2 + 64;
+    if (b0.bitLength() <= stop)
+        return false;
+    BigInt a = a0;
+    BigInt b = b0;
+    if (a.length >= HGCD_BASE_THRESHOLD) {
+        // The leading half of the bits gives the first matrix, which
+        // brings the numbers to about three quarters of their size
+        std::size_t shift = bits / 2;
+        Matrix first;
+        if (halfGcd(a >> shift, b >> shift, first)) {
+            first.apply(a, b);
+            normalizePair(a, b, first);
+            m = first;
+        }
+        // Then the leading part that is left gives the second half
+        std::size_t remaining = a.bitLength();
+        if (b.bitLength() > stop && remaining < bits) {
+            Matrix second;
+            shift = bits - remaining;
+            if (halfGcd(a >> shift, b >> shift, second)) {
+                second.apply(a, b);
+                normalizePair(a, b, second);
+                m.leftMultiply(second);
+            }
+        }
+    }
+    reduceTo(a, b, stop, m);
+    return !(m.m[0][1].isZero() && m.m[1][0].isZero());
+}
+
+inline BigInt BigInt::gcd(BigInt a, BigInt b) {
+    a.negative = false;
+    b.negative = false;
+    if (a < b)
+        std::swap(a, b);
+    BigInt spareA, spareB;
+    while (!b.isZero()) {
+        if (a.length <= INLINE_LIMBS) {
+            DoubleLimb x = a.smallMagnitude();
+            gcdSmall(x, b.smallMagnitude());
+            return BigInt(x);
+        }
+        if (b.length >= HGCD_THRESHOLD && b.bitLength() + 64 >= a.bitLength()) {
+            std::size_t before = a.bitLength();
+            Matrix m;
+            if (halfGcd(a, b, m)) {
+                m.apply(a, b);
+                normalizePair(a, b, m);
+                if (a.bitLength() + 64 < before)
+                    continue;
+            }
+            divisionStep(a, b);
+            continue;
+        }
+        lehmerStep(a, b, spareA, spareB);
+    }
+    return a;
+}
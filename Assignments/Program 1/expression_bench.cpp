@@ -0,0 +1,157 @@
+/*****************************************************************************
+*
+*  Author:           Jesus Mendoza
+*  Email:            jesus.kyx.mendoza11@gmail.com
+*  Label:            Program 1 - Fraction Class
+*  Title:            Expression Template Benchmark
+*  Course:           CMPS 2143
+*  Semester:         Fall 2024
+*
+*  Description:
+*        Times whole expressions written out in source, evaluated two ways:
+*
+*            plain  the ordinary Fraction operators, which reduce a
+*                   temporary at every operator
+*            lazy   the same expression started with lazy() (see
+*                   fraction_expression.hpp): one pass, one reduction
+*
+*        The expressions are a + b + c * d and dot products
+*        x[0] * y[0] + ... + x[n-1] * y[n-1] of 4 to 32 terms, for int and
+*        long long fractions. Numerators are random in [-50, 50], and
+*        denominators are random divisors of 60, as with prices or
+*        measurements on a common scale. Before timing, every expression's
+*        two results are checked to be equal. Each cell is the median over
+*        --reps runs of the time per expression.
+*
+*  Usage:
+*        g++ -std=c++20 -O2 -march=native expression_bench.cpp -o expression_bench
+*        ./expression_bench [--reps n] [--count n] [--seed n]
+*
+*  Files:
+*        expression_bench.cpp     : This benchmark.
+*        fraction_expression.hpp  : lazy() and the expression nodes.
+*        fraction.hpp             : Fraction<T>.
+*
+*****************************************************************************/
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "fraction.hpp"
+#include "fraction_expression.hpp"
+
+using namespace std;
+
+const int DIVISORS_OF_60[] = {1, 2, 3, 4, 5, 6, 10, 12, 15, 20, 30, 60};
+
+template <typename T, size_t... I>
+Fraction<T> dotPlain(const Fraction<T>* x, const Fraction<T>* y, index_sequence<I...>) {
+    return (... + (x[I] * y[I]));
+}
+
+template <typename T, size_t... I>
+Fraction<T> dotLazy(const Fraction<T>* x, const Fraction<T>* y, index_sequence<I...>) {
+    return (... + (lazy(x[I]) * y[I]));
+}
+
+template <typename T>
+Fraction<T> mixedPlain(const Fraction<T>* x, const Fraction<T>*) {
+    return x[0] + x[1] + x[2] * x[3];
+}
+
+template <typename T>
+Fraction<T> mixedLazy(const Fraction<T>* x, const Fraction<T>*) {
+    return lazy(x[0]) + x[1] + lazy(x[2]) * x[3];
+}
+
+// Median nanoseconds per expression over reps runs, one expression per
+// group of inputs
+template <typename T, typename Eval>
+double timeExpression(const vector<Fraction<T>>& x, const vector<Fraction<T>>& y, size_t terms, int reps,
+                      Eval eval) {
+    vector<double> samples;
+    T sink = 0;
+    size_t count = x.size() / terms;
+    for (int rep = 0; rep < reps; ++rep) {
+        auto start = chrono::steady_clock::now();
+        for (size_t i = 0; i < count; ++i)
+            sink += eval(&x[i * terms], &y[i * terms]).getNumerator();
+        samples.push_back(chrono::duration<double, nano>(chrono::steady_clock::now() - start).count() / count);
+    }
+    volatile T keep = sink;  // Keeps the timed calls from being optimized away
+    (void)keep;
+    nth_element(samples.begin(), samples.begin() + reps / 2, samples.end());
+    return samples[reps / 2];
+}
+
+template <typename T, typename Plain, typename Lazy>
+bool benchExpression(const string& type, const string& name, size_t terms, size_t count, int reps, uint64_t seed,
+                     Plain plain, Lazy lazyEval) {
+    mt19937_64 random(seed + terms);
+    vector<Fraction<T>> x, y;
+    for (size_t i = 0; i < count * terms; ++i) {
+        x.emplace_back(static_cast<T>(static_cast<int>(random() % 101) - 50), static_cast<T>(DIVISORS_OF_60[random() % 12]));
+        y.emplace_back(static_cast<T>(static_cast<int>(random() % 101) - 50), static_cast<T>(DIVISORS_OF_60[random() % 12]));
+    }
+    for (size_t i = 0; i < count; ++i) {
+        if (!(plain(&x[i * terms], &y[i * terms]) == lazyEval(&x[i * terms], &y[i * terms]))) {
+            cout << "Error: plain and lazy results differ for " << type << " " << name << endl;
+            return false;
+        }
+    }
+
+    double plainTime = timeExpression<T>(x, y, terms, reps, plain);
+    double lazyTime = timeExpression<T>(x, y, terms, reps, lazyEval);
+    cout << left << setw(11) << type << setw(16) << name << right << fixed << setprecision(1) << setw(10) << plainTime
+         << setw(10) << lazyTime << setw(9) << setprecision(2) << plainTime / lazyTime << "x" << endl;
+    return true;
+}
+
+template <typename T, size_t N>
+bool benchDot(const string& type, size_t count, int reps, uint64_t seed) {
+    return benchExpression<T>(
+        type, "dot " + to_string(N), N, count, reps, seed,
+        [](const Fraction<T>* x, const Fraction<T>* y) { return dotPlain(x, y, make_index_sequence<N>()); },
+        [](const Fraction<T>* x, const Fraction<T>* y) { return dotLazy(x, y, make_index_sequence<N>()); });
+}
+
+template <typename T>
+bool benchType(const string& type, size_t count, int reps, uint64_t seed) {
+    bool correct = benchExpression<T>(type, "a + b + c * d", 4, count, reps, seed, mixedPlain<T>, mixedLazy<T>);
+    correct = benchDot<T, 4>(type, count, reps, seed) && correct;
+    correct = benchDot<T, 8>(type, count, reps, seed) && correct;
+    correct = benchDot<T, 16>(type, count, reps, seed) && correct;
+    correct = benchDot<T, 32>(type, count, reps, seed) && correct;
+    return correct;
+}
+
+int main(int argc, char* argv[]) {
+    int reps = 15;
+    size_t count = 2048;
+    uint64_t seed = 0x4C415A59;
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--reps") == 0 && i + 1 < argc)
+            reps = max(1, atoi(argv[++i]));
+        else if (strcmp(argv[i], "--count") == 0 && i + 1 < argc)
+            count = max(1, atoi(argv[++i]));
+        else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc)
+            seed = strtoull(argv[++i], nullptr, 10);
+    }
+
+    cout << "Nanoseconds per expression, median of " << reps << " runs over " << count << " expressions" << endl;
+    cout << left << setw(11) << "type" << setw(16) << "expression" << right << setw(10) << "plain" << setw(10)
+         << "lazy" << setw(10) << "speedup" << endl;
+
+    bool correct = benchType<int>("int", count, reps, seed);
+    correct = benchType<long long>("long long", count, reps, seed) && correct;
+    return correct ? 0 : 1;
+}
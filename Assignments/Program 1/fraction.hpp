@@ -0,0 +1,508 @@
+/*****************************************************************************
+*
+*  Author:           Jesus Mendoza
+*  Email:            jesus.kyx.mendoza11@gmail.com
+*  Label:            Program 1 - Fraction Class
+*  Title:            Fraction Class Template
+*  Course:           CMPS 2143
+*  Semester:         Fall 2024
+*
+*  Description:
+*        A fraction class templated on its signed integer type: 32-bit,
+*        64-bit, or 128-bit (__int128, on compilers that have it). Fractions
+*        are always kept in lowest terms with a positive denominator.
+*
+*        Every operation first runs in T with the compiler's overflow-checked
+*        arithmetic (__builtin_add_overflow and friends), which costs about
+*        the same as plain arithmetic. Only if one of those steps overflows is
+*        the operation done again in the next wider type (int32 to int64,
+*        int64 to __int128), where it cannot overflow. The reduced result is
+*        then narrowed back to T. If it still does not fit, std::overflow_error
+*        is thrown, so an answer is never silently wrong.
+*
+*        __int128 has no wider type, so Fraction<__int128> throws as soon as
+*        an intermediate product or sum overflows, even when the reduced
+*        result would fit. For example, -(2^125)/5 - (-(2^127 - 2))/17 is
+*        (3 * 2^125 - 10)/85, which fits, but computing it throws.
+*
+*        Results come out already in lowest terms (Henrici's algorithms):
+*        + and - take a GCD of the two denominators and, only when that is
+*        not 1, a second small one, while * and / cancel the operands
+*        against each other before multiplying. Neither needs a GCD of the
+*        full result. For long sums, FractionAccumulator in
+*        fraction_accumulator.hpp skips even those until the value is read,
+*        and lazy() in fraction_expression.hpp evaluates a whole expression
+*        with one reduction.
+*
+*  Usage:
+*        #include "fraction.hpp"
+*        Fraction a(1, 2);                  // Fraction<int>
+*        Fraction<long long> b(3, 4);
+*        Fraction<__int128> c(1, 3);
+*        std::cout << a + a << std::endl;   // 1/1
+*
+*  Files:
+*        fraction.hpp                : This header.
+*        gcd.hpp                     : GCD kernels used by reduce().
+*        fraction_accumulator.hpp    : Unreduced running sums.
+*        FractionHW - CMPS 2143.cpp  : Driver program.
+*
+*****************************************************************************/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+
+#include "gcd.hpp"
+
+// Unsigned type of the same width, and the next wider signed type (void if
+// there is none), for each supported size of integer
+template <std::size_t Bytes>
+struct FractionWidth;
+
+template <>
+struct FractionWidth<4> {
+    using Unsigned = std::uint32_t;
+    using Wider = std::int64_t;
+};
+
+template <>
+struct FractionWidth<8> {
+    using Unsigned = std::uint64_t;
+#ifdef __SIZEOF_INT128__
+    using Wider = __int128;
+#else
+    using Wider = void;
+#endif
+};
+
+#ifdef __SIZEOF_INT128__
+template <>
+struct FractionWidth<16> {
+    using Unsigned = unsigned __int128;
+    using Wider = void;
+};
+#endif
+
+// Decimal text of any supported integer, including __int128, which the
+// standard streams cannot print
+template <typename T>
+std::string integerToString(T value) {
+    using Unsigned = typename FractionWidth<sizeof(T)>::Unsigned;
+    Unsigned magnitude = value < 0 ? Unsigned(0) - static_cast<Unsigned>(value) : static_cast<Unsigned>(value);
+    char digits[48];
+    char* first = digits + sizeof(digits);
+    do {
+        *--first = static_cast<char>('0' + static_cast<int>(magnitude % 10));
+        magnitude /= 10;
+    } while (magnitude != 0);
+    if (value < 0)
+        *--first = '-';
+    return std::string(first, digits + sizeof(digits));
+}
+
+// Hash of any supported integer, folding the two halves of __int128
+template <typename T>
+std::size_t integerHash(T value) {
+    using Unsigned = typename FractionWidth<sizeof(T)>::Unsigned;
+    auto bits = static_cast<Unsigned>(value);
+    std::uint64_t folded = static_cast<std::uint64_t>(bits);
+    if constexpr (sizeof(T) > 8)
+        folded ^= static_cast<std::uint64_t>(bits >> 64) * 0x9E3779B97F4A7C15ull;
+    return static_cast<std::size_t>(folded ^ (folded >> 29));
+}
+
+// Hash of a reduced fraction given by its fields
+template <typename T>
+std::size_t fractionHash(T num, T den) {
+    return integerHash(num) * 0x9E3779B97F4A7C15ull + integerHash(den);
+}
+
+template <typename T>
+class FractionAccumulator;
+
+/**
+ * Class Fraction
+ *
+ * Description:
+ *      This class represents a fraction with a numerator and denominator of
+ *      type T. It supports addition, subtraction, multiplication, division
+ *      and equality, and is always stored in reduced form. Operations that
+ *      overflow T are redone in a wider type (see the file description).
+ *
+ * Public Methods:
+ *      - Fraction(T num = 0, T den = 1)
+ *      - explicit Fraction(const Fraction<U>& other)
+ *      - T getNumerator() const
+ *      - T getDenominator() const
+ *      - Fraction operator+(const Fraction& other) const
+ *      - Fraction operator-(const Fraction& other) const
+ *      - Fraction operator*(const Fraction& other) const
+ *      - Fraction operator/(const Fraction& other) const
+ *      - bool operator==(const Fraction& other) const
+ *      - friend std::ostream& operator<<(std::ostream& os, const Fraction& frac)
+ *      - static T gcd(T a, T b)
+ *      - static T lcm(T a, T b)
+ *      - static T lcd(T a, T b)
+ *
+ * Private Methods:
+ *      - Fraction(T num, T den, Reduced)
+ *      - void reduce()
+ *      - bool sumFits(const Fraction& other, bool subtract, T& num, T& den) const
+ *      - bool productFits(T otherNum, T otherDen, T& num, T& den) const
+ *      - Fraction widen(const Fraction& other, Op op) const
+ */
+template <typename T = int>
+class Fraction {
+    static_assert(static_cast<T>(-1) < static_cast<T>(0), "Fraction needs a signed integer type");
+
+public:
+    using Unsigned = typename FractionWidth<sizeof(T)>::Unsigned;
+    using Wider = typename FractionWidth<sizeof(T)>::Wider;
+    // Where unreduced results are kept: Wider, or T when there is none
+    using Storage = std::conditional_t<std::is_void_v<Wider>, T, Wider>;
+
+    static constexpr T MAX_VALUE = static_cast<T>(~Unsigned(0) >> 1);
+    static constexpr T MIN_VALUE = -MAX_VALUE - 1;
+
+private:
+    T numerator;   // numerator of the fraction
+    T denominator; // denominator of the fraction, always positive
+
+    template <typename>
+    friend class Fraction;
+    template <typename>
+    friend class FractionAccumulator;
+
+    // Tag for results that are already in lowest terms and skip reduce()
+    struct Reduced {};
+
+    Fraction(T num, T den, Reduced) : numerator(num), denominator(den) {}
+
+    static Unsigned magnitude(T value) {
+        return value < 0 ? Unsigned(0) - static_cast<Unsigned>(value) : static_cast<Unsigned>(value);
+    }
+
+    static Unsigned gcdMagnitude(Unsigned a, Unsigned b) { return GcdEngine<Unsigned>::gcd(a, b); }
+
+    /**
+     * reduce
+     *
+     * Description:
+     *      Reduces the fraction to its lowest terms using the GCD and makes
+     *      the denominator positive. Works on magnitudes, so MIN_VALUE is
+     *      handled without overflow.
+     *
+     * Throws:
+     *      overflow_error - if the reduced fraction does not fit in T (only
+     *      possible for a MIN_VALUE numerator with a negative denominator)
+     */
+    void reduce() {
+        bool negative = (numerator < 0) != (denominator < 0);
+        Unsigned n = magnitude(numerator);
+        Unsigned d = magnitude(denominator);
+        Unsigned g = gcdMagnitude(n, d);
+        n /= g;
+        d /= g;
+        Unsigned limit = static_cast<Unsigned>(MAX_VALUE);
+        if (d > limit || n > limit + (negative ? 1 : 0))
+            throw std::overflow_error("Fraction does not fit in " + std::to_string(8 * sizeof(T)) + " bits");
+        numerator = static_cast<T>(negative ? Unsigned(0) - n : n);
+        denominator = static_cast<T>(d);
+    }
+
+    /**
+     * sumFits
+     *
+     * Description:
+     *      Computes the sum or difference with Henrici's algorithm. With
+     *      g = gcd(b, d), a/b + c/d has numerator t = a(d/g) + c(b/g), and
+     *      any common factor of t and the result's denominator divides g.
+     *      So the result is t/g2 over (b/g)(d/g2) with g2 = gcd(t, g), and
+     *      no GCD of the full numerator and denominator is needed. When the
+     *      denominators are coprime (g = 1) there is no second GCD at all.
+     *
+     * Returns:
+     *      bool - false if any step overflowed, leaving num and den unset
+     */
+    bool sumFits(const Fraction& other, bool subtract, T& num, T& den) const {
+        T g = gcd(denominator, other.denominator);
+        T left = other.denominator / g;  // Scales this fraction to the common denominator
+        T right = denominator / g;       // Scales the other one
+        T a, b, t;
+        if (__builtin_mul_overflow(numerator, left, &a) || __builtin_mul_overflow(other.numerator, right, &b))
+            return false;
+        if (subtract ? __builtin_sub_overflow(a, b, &t) : __builtin_add_overflow(a, b, &t))
+            return false;
+        if (t == 0) {
+            num = 0;
+            den = 1;
+            return true;
+        }
+        T g2 = g == 1 ? 1 : gcd(t, g);
+        num = t / g2;
+        return !__builtin_mul_overflow(right, other.denominator / g2, &den);
+    }
+
+    /**
+     * productFits
+     *
+     * Description:
+     *      Multiplies by otherNum/otherDen (in lowest terms, otherDen of
+     *      either sign) with Henrici's algorithm: a/b * c/d is (a/g1)(c/g2)
+     *      over (b/g2)(d/g1) with g1 = gcd(a, d) and g2 = gcd(c, b), which
+     *      is already reduced. The GCDs are of the operands, not of their
+     *      products, and the cancelled products are smaller, so fewer of
+     *      them overflow. Works on magnitudes so that MIN_VALUE is handled
+     *      without overflow.
+     *
+     * Returns:
+     *      bool - false if any step overflowed, leaving num and den unset
+     */
+    bool productFits(T otherNum, T otherDen, T& num, T& den) const {
+        if (numerator == 0 || otherNum == 0) {
+            num = 0;
+            den = 1;
+            return true;
+        }
+        bool negative = (numerator < 0) != ((otherNum < 0) != (otherDen < 0));
+        Unsigned a = magnitude(numerator);
+        Unsigned c = magnitude(otherNum);
+        Unsigned d = magnitude(otherDen);
+        Unsigned g1 = gcdMagnitude(a, d);
+        Unsigned g2 = gcdMagnitude(c, static_cast<Unsigned>(denominator));
+        Unsigned n, m;
+        if (__builtin_mul_overflow(a / g1, c / g2, &n) ||
+            __builtin_mul_overflow(static_cast<Unsigned>(denominator) / g2, d / g1, &m))
+            return false;
+        Unsigned limit = static_cast<Unsigned>(MAX_VALUE);
+        if (m > limit || n > limit + (negative ? 1 : 0))
+            return false;
+        num = static_cast<T>(negative ? Unsigned(0) - n : n);
+        den = static_cast<T>(m);
+        return true;
+    }
+
+    /**
+     * widen
+     *
+     * Description:
+     *      Redoes an operation that overflowed T in the next wider type, where
+     *      the operands' products cannot overflow, and narrows the result.
+     *
+     * Returns:
+     *      Fraction - op applied to *this and other
+     *
+     * Throws:
+     *      overflow_error - if the result does not fit in T, or T is already
+     *      the widest type
+     */
+    template <typename Op>
+    Fraction widen(const Fraction& other, Op op) const {
+        if constexpr (std::is_void_v<Wider>) {
+            throw std::overflow_error("Fraction result does not fit in " + std::to_string(8 * sizeof(T)) + " bits");
+        } else {
+            return Fraction(op(Fraction<Wider>(*this), Fraction<Wider>(other)));
+        }
+    }
+
+public:
+    /**
+     * Fraction (Constructor)
+     *
+     * Description:
+     *      Constructs a fraction with a given numerator and denominator.
+     *      If the denominator is zero, it defaults to 1 to avoid division by zero.
+     */
+    Fraction(T num = 0, T den = 1) : numerator(num), denominator(den) {
+        if (den == 0) {
+            std::cout << "Error: Denominator cannot be zero." << std::endl;
+            denominator = 1;  // Set a default valid denominator
+        }
+        reduce(); // Simplify the fraction
+    }
+
+    /**
+     * Fraction (Converting Constructor)
+     *
+     * Description:
+     *      Converts a fraction of another integer type.
+     *
+     * Throws:
+     *      overflow_error - if the value does not fit in T
+     */
+    template <typename U>
+    explicit Fraction(const Fraction<U>& other) {
+        using Common = std::conditional_t<(sizeof(U) > sizeof(T)), U, T>;
+        Common num = static_cast<Common>(other.numerator);
+        Common den = static_cast<Common>(other.denominator);
+        if (num < static_cast<Common>(MIN_VALUE) || num > static_cast<Common>(MAX_VALUE) ||
+            den > static_cast<Common>(MAX_VALUE))
+            throw std::overflow_error("Fraction result does not fit in " + std::to_string(8 * sizeof(T)) + " bits");
+        numerator = static_cast<T>(num);
+        denominator = static_cast<T>(den);
+    }
+
+    T getNumerator() const { return numerator; }
+    T getDenominator() const { return denominator; }
+
+    /**
+     * operator+
+     *
+     * Description:
+     *      Overloads the addition operator to add two fractions.
+     *
+     * Returns:
+     *      Fraction - the resulting fraction after addition
+     *
+     * Throws:
+     *      overflow_error - if the result does not fit in T
+     */
+    Fraction operator+(const Fraction& other) const {
+        T num, den;
+        if (sumFits(other, false, num, den))
+            return Fraction(num, den, Reduced{});
+        return widen(other, [](const auto& a, const auto& b) { return a + b; });
+    }
+
+    /**
+     * operator-
+     *
+     * Description:
+     *      Overloads the subtraction operator to subtract two fractions.
+     *
+     * Returns:
+     *      Fraction - the resulting fraction after subtraction
+     *
+     * Throws:
+     *      overflow_error - if the result does not fit in T
+     */
+    Fraction operator-(const Fraction& other) const {
+        T num, den;
+        if (sumFits(other, true, num, den))
+            return Fraction(num, den, Reduced{});
+        return widen(other, [](const auto& a, const auto& b) { return a - b; });
+    }
+
+    /**
+     * operator*
+     *
+     * Description:
+     *      Overloads the multiplication operator to multiply two fractions.
+     *
+     * Returns:
+     *      Fraction - the resulting fraction after multiplication
+     *
+     * Throws:
+     *      overflow_error - if the result does not fit in T
+     */
+    Fraction operator*(const Fraction& other) const {
+        T num, den;
+        if (productFits(other.numerator, other.denominator, num, den))
+            return Fraction(num, den, Reduced{});
+        return widen(other, [](const auto& a, const auto& b) { return a * b; });
+    }
+
+    /**
+     * operator/
+     *
+     * Description:
+     *      Overloads the division operator to divide two fractions.
+     *
+     * Returns:
+     *      Fraction - the resulting fraction after division
+     *
+     * Throws:
+     *      invalid_argument - if division by zero is attempted
+     *      overflow_error - if the result does not fit in T
+     */
+    Fraction operator/(const Fraction& other) const {
+        if (other.numerator == 0) {
+            throw std::invalid_argument("Cannot divide by zero.");
+        }
+        T num, den;
+        if (productFits(other.denominator, other.numerator, num, den))
+            return Fraction(num, den, Reduced{});
+        return widen(other, [](const auto& a, const auto& b) { return a / b; });
+    }
+
+    /**
+     * operator==
+     *
+     * Description:
+     *      Overloads the equality operator to compare two fractions.
+     *
+     * Returns:
+     *      bool - true if the fractions are equal, false otherwise
+     */
+    bool operator==(const Fraction& other) const {
+        return (numerator == other.numerator && denominator == other.denominator);
+    }
+
+    /**
+     * operator<<
+     *
+     * Description:
+     *      Overloads the output stream operator to print a fraction.
+     */
+    friend std::ostream& operator<<(std::ostream& os, const Fraction& frac) {
+        os << integerToString(frac.numerator) << "/" << integerToString(frac.denominator);
+        return os;
+    }
+
+    /**
+     * gcd
+     *
+     * Description:
+     *      Calculates the greatest common divisor (GCD) of two integers
+     *      with the kernel selected for this width (see gcd.hpp). The
+     *      result is never negative.
+     */
+    static T gcd(T a, T b) { return static_cast<T>(gcdMagnitude(magnitude(a), magnitude(b))); }
+
+    /**
+     * lcm
+     *
+     * Description:
+     *      Calculates the least common multiple (LCM) of two integers.
+     *
+     * Throws:
+     *      overflow_error - if the LCM does not fit in T
+     */
+    static T lcm(T a, T b) {
+        if (a == 0 || b == 0)
+            return 0;
+        Unsigned result;
+        Unsigned x = magnitude(a);
+        Unsigned y = magnitude(b);
+        if (__builtin_mul_overflow(x / gcdMagnitude(x, y), y, &result) || result > static_cast<Unsigned>(MAX_VALUE))
+            throw std::overflow_error("LCM does not fit in " + std::to_string(8 * sizeof(T)) + " bits");
+        return static_cast<T>(result);
+    }
+
+    /**
+     * lcd
+     *
+     * Description:
+     *      Calculates the least common denominator (LCD) of two fractions,
+     *      which is the same as the LCM of their denominators.
+     */
+    static T lcd(T a, T b) { return lcm(a, b); }
+};
+
+// Lets fractions be keys of unordered containers. Equal fractions have
+// equal fields, since both are always reduced.
+namespace std {
+template <typename T>
+struct hash<Fraction<T>> {
+    size_t operator()(const Fraction<T>& frac) const noexcept {
+        return fractionHash(frac.getNumerator(), frac.getDenominator());
+    }
+};
+}  // namespace std
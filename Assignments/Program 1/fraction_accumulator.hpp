@@ -0,0 +1,262 @@
+/*****************************************************************************
+*
+*  Author:           Jesus Mendoza
+*  Email:            jesus.kyx.mendoza11@gmail.com
+*  Label:            Program 1 - Fraction Class
+*  Title:            Unreduced Fraction Accumulator
+*  Course:           CMPS 2143
+*  Semester:         Fall 2024
+*
+*  Description:
+*        A running sum of Fraction<T> values that is not kept in lowest
+*        terms. Adding c/d to n/m just sets the sum to (nd + cm)/(md), or to
+*        (n + c)/m when the denominators are equal. That is two or three
+*        multiplications and no GCD at all.
+*
+*        The sum is reduced only when it is read: by value(), ==, printing,
+*        hashing or the getters. It is kept in the next wider type (int64
+*        for int, __int128 for long long), so many terms fit before the
+*        unreduced numbers run out of room. When they do, that one step is
+*        done exactly with Fraction's reduced arithmetic and accumulation
+*        goes on from the reduced sum. The result is always the same as
+*        adding the fractions one by one. value() throws std::overflow_error
+*        if the sum does not fit in T.
+*
+*        Reading a sum reduces it in place, so even a const accumulator
+*        must not be read from two threads at once.
+*
+*  Usage:
+*        #include "fraction_accumulator.hpp"
+*        FractionAccumulator<long long> total;
+*        for (const Fraction<long long>& price : prices)
+*            total += price;
+*        Fraction<long long> sum = total.value();
+*
+*  Files:
+*        fraction_accumulator.hpp  : This header.
+*        fraction.hpp              : Fraction<T>.
+*
+*****************************************************************************/
+
+#pragma once
+
+#include <iostream>
+
+#include "fraction.hpp"
+
+/**
+ * Class FractionAccumulator
+ *
+ * Description:
+ *      A sum of fractions that puts off reducing until it is read.
+ *
+ * Public Methods:
+ *      - FractionAccumulator(const Fraction<T>& start = Fraction<T>())
+ *      - FractionAccumulator& operator+=(const Fraction<T>& other)
+ *      - FractionAccumulator& operator-=(const Fraction<T>& other)
+ *      - Fraction<T> value() const
+ *      - Storage getNumerator() const
+ *      - Storage getDenominator() const
+ *      - bool operator==(const FractionAccumulator& other) const
+ *      - bool operator==(const Fraction<T>& other) const
+ *      - friend std::ostream& operator<<(std::ostream& os, const FractionAccumulator& sum)
+ *
+ * Private Methods:
+ *      - void normalize() const
+ *      - void add(const Fraction<T>& other, bool subtract)
+ */
+template <typename T = int>
+class FractionAccumulator {
+public:
+    using Storage = typename Fraction<T>::Storage;
+
+private:
+    using Reduced = typename Fraction<Storage>::Reduced;
+
+    mutable Storage numerator = 0;    // numerator of the sum, not reduced
+    mutable Storage denominator = 1;  // denominator of the sum, always positive
+    mutable bool reduced = true;      // whether the two are in lowest terms
+
+    /**
+     * normalize
+     *
+     * Description:
+     *      Reduces the sum to lowest terms, if it is not already.
+     */
+    void normalize() const {
+        if (reduced)
+            return;
+        Fraction<Storage> value(numerator, denominator);
+        numerator = value.numerator;
+        denominator = value.denominator;
+        reduced = true;
+    }
+
+    /**
+     * add
+     *
+     * Description:
+     *      Adds or subtracts a fraction without reducing. If the unreduced
+     *      result would overflow Storage, does this one step with reduced
+     *      arithmetic instead.
+     *
+     * Throws:
+     *      overflow_error - if even the reduced sum does not fit in Storage
+     */
+    void add(const Fraction<T>& other, bool subtract) {
+        Storage c = other.getNumerator();
+        Storage d = other.getDenominator();
+        Storage n, m = denominator;
+        bool fits;
+        if (d == denominator) {
+            fits = !(subtract ? __builtin_sub_overflow(numerator, c, &n) : __builtin_add_overflow(numerator, c, &n));
+        } else {
+            Storage left, right;
+            fits = !__builtin_mul_overflow(numerator, d, &left) && !__builtin_mul_overflow(c, denominator, &right) &&
+                   !(subtract ? __builtin_sub_overflow(left, right, &n) : __builtin_add_overflow(left, right, &n)) &&
+                   !__builtin_mul_overflow(denominator, d, &m);
+        }
+        if (fits) {
+            numerator = n;
+            denominator = m;
+            reduced = false;
+            return;
+        }
+
+        normalize();
+        Fraction<Storage> current(numerator, denominator, Reduced{});
+        Fraction<Storage> next = subtract ? current - Fraction<Storage>(other) : current + Fraction<Storage>(other);
+        numerator = next.numerator;
+        denominator = next.denominator;
+    }
+
+public:
+    /**
+     * FractionAccumulator (Constructor)
+     *
+     * Description:
+     *      Starts the sum at a given fraction, 0 by default.
+     */
+    FractionAccumulator(const Fraction<T>& start = Fraction<T>())
+        : numerator(start.getNumerator()), denominator(start.getDenominator()) {}
+
+    /**
+     * operator+=
+     *
+     * Description:
+     *      Adds a fraction to the sum.
+     *
+     * Returns:
+     *      FractionAccumulator& - this sum
+     *
+     * Throws:
+     *      overflow_error - if the sum does not fit in Storage
+     */
+    FractionAccumulator& operator+=(const Fraction<T>& other) {
+        add(other, false);
+        return *this;
+    }
+
+    /**
+     * operator-=
+     *
+     * Description:
+     *      Subtracts a fraction from the sum.
+     *
+     * Returns:
+     *      FractionAccumulator& - this sum
+     *
+     * Throws:
+     *      overflow_error - if the sum does not fit in Storage
+     */
+    FractionAccumulator& operator-=(const Fraction<T>& other) {
+        add(other, true);
+        return *this;
+    }
+
+    /**
+     * value
+     *
+     * Description:
+     *      Reduces the sum and returns it as a Fraction<T>.
+     *
+     * Returns:
+     *      Fraction<T> - the sum in lowest terms
+     *
+     * Throws:
+     *      overflow_error - if the sum does not fit in T
+     */
+    Fraction<T> value() const {
+        normalize();
+        return Fraction<T>(Fraction<Storage>(numerator, denominator, Reduced{}));
+    }
+
+    Storage getNumerator() const {
+        normalize();
+        return numerator;
+    }
+
+    Storage getDenominator() const {
+        normalize();
+        return denominator;
+    }
+
+    /**
+     * operator==
+     *
+     * Description:
+     *      Compares two sums by value.
+     *
+     * Returns:
+     *      bool - true if the sums are equal, false otherwise
+     */
+    bool operator==(const FractionAccumulator& other) const {
+        normalize();
+        other.normalize();
+        return numerator == other.numerator && denominator == other.denominator;
+    }
+
+    /**
+     * operator==
+     *
+     * Description:
+     *      Compares the sum with a fraction.
+     *
+     * Returns:
+     *      bool - true if they are equal, false otherwise
+     */
+    bool operator==(const Fraction<T>& other) const {
+        normalize();
+        return numerator == static_cast<Storage>(other.getNumerator()) &&
+               denominator == static_cast<Storage>(other.getDenominator());
+    }
+
+    /**
+     * operator<<
+     *
+     * Description:
+     *      Prints the reduced sum, even if it does not fit in T.
+     */
+    friend std::ostream& operator<<(std::ostream& os, const FractionAccumulator& sum) {
+        sum.normalize();
+        os << integerToString(sum.numerator) << "/" << integerToString(sum.denominator);
+        return os;
+    }
+};
+
+// Hashes the same as the equal Fraction<T>, so sums and fractions can be
+// looked up interchangeably
+namespace std {
+template <typename T>
+struct hash<FractionAccumulator<T>> {
+    size_t operator()(const FractionAccumulator<T>& sum) const noexcept {
+        using Storage = typename FractionAccumulator<T>::Storage;
+        Storage num = sum.getNumerator();
+        Storage den = sum.getDenominator();
+        if (num >= static_cast<Storage>(Fraction<T>::MIN_VALUE) && num <= static_cast<Storage>(Fraction<T>::MAX_VALUE) &&
+            den <= static_cast<Storage>(Fraction<T>::MAX_VALUE))
+            return fractionHash(static_cast<T>(num), static_cast<T>(den));
+        return fractionHash(num, den);
+    }
+};
+}  // namespace std
@@ -0,0 +1,305 @@
+/*****************************************************************************
+*
+*  Author:           Jesus Mendoza
+*  Email:            jesus.kyx.mendoza11@gmail.com
+*  Label:            Program 1 - Fraction Class
+*  Title:            Fraction Expression Templates
+*  Course:           CMPS 2143
+*  Semester:         Fall 2024
+*
+*  Description:
+*        With plain Fraction operators, a + b + c * d makes and reduces a
+*        temporary at every operator. Starting an expression with lazy()
+*        makes the operators build a tree of the expression instead, with no
+*        arithmetic done yet. The tree is evaluated when it is converted to
+*        a Fraction<T>:
+*
+*            1. One pass over the tree in T, with no reducing. Sums use
+*               the least common denominator of their two sides (one GCD
+*               of denominators, none if they are equal). Products and
+*               quotients just multiply.
+*            2. One reduction of the final numerator and denominator.
+*
+*        So a dot product of n terms takes n GCDs of denominators and one
+*        full reduction, instead of about 3n GCDs. Every step is overflow
+*        checked. If the unreduced numbers outgrow T, the pass is redone
+*        in the next wider type (int64 for int, __int128 for long long), and
+*        if they outgrow that too, the expression is evaluated again
+*        operator by operator with Fraction.
+*        So the result is always the one the plain operators give, except
+*        that it can also succeed where one of their temporaries would not
+*        have fit in T.
+*
+*        The tree holds references to the fractions in it, so it must be
+*        evaluated in the statement that builds it. Do not keep it in an
+*        auto variable.
+*
+*  Usage:
+*        #include "fraction_expression.hpp"
+*        Fraction<int> r = lazy(a) + b + lazy(c) * d;
+*        Fraction<long long> dot = lazy(x[0]) * y[0] + lazy(x[1]) * y[1] + lazy(x[2]) * y[2];
+*
+*        Fraction * Fraction is still an ordinary product, so each product
+*        in an expression should start with lazy() too.
+*
+*  Files:
+*        fraction_expression.hpp  : This header.
+*        fraction.hpp             : Fraction<T>.
+*        expression_bench.cpp     : Compares lazy and plain evaluation.
+*
+*****************************************************************************/
+
+#pragma once
+
+#include <concepts>
+#include <iostream>
+#include <stdexcept>
+#include <type_traits>
+
+#include "fraction.hpp"
+
+/**
+ * Class FractionExpression
+ *
+ * Description:
+ *      Base of every node of an expression tree. Derived is the node type
+ *      and T the integer type of the fractions in it. A node provides
+ *      fused(num, den), which computes the unreduced value in T or Storage
+ *      and returns false on overflow, and eager(), which evaluates it with
+ *      the plain Fraction operators.
+ *
+ * Public Methods:
+ *      - Fraction<T> evaluate() const
+ *      - operator Fraction<T>() const
+ *      - friend std::ostream& operator<<(std::ostream& os, const FractionExpression& expr)
+ */
+template <typename Derived, typename T>
+class FractionExpression {
+public:
+    using Integer = T;
+    using Storage = typename Fraction<T>::Storage;
+
+    /**
+     * evaluate
+     *
+     * Description:
+     *      Evaluates the expression in one pass with a single reduction at
+     *      the end, in T or else in Storage, or operator by operator if
+     *      both overflow.
+     *
+     * Returns:
+     *      Fraction<T> - the value of the expression
+     *
+     * Throws:
+     *      invalid_argument - if the expression divides by zero
+     *      overflow_error - if the value does not fit in T
+     */
+    Fraction<T> evaluate() const {
+        const Derived& expr = static_cast<const Derived&>(*this);
+        T num, den;
+        if (expr.fused(num, den))
+            return Fraction<T>(num, den);
+        if constexpr (!std::is_same_v<Storage, T>) {
+            Storage wideNum, wideDen;
+            if (expr.fused(wideNum, wideDen))
+                return Fraction<T>(Fraction<Storage>(wideNum, wideDen));
+        }
+        return expr.eager();
+    }
+
+    operator Fraction<T>() const { return evaluate(); }
+
+    /**
+     * operator<<
+     *
+     * Description:
+     *      Evaluates the expression and prints it.
+     */
+    friend std::ostream& operator<<(std::ostream& os, const FractionExpression& expr) {
+        os << expr.evaluate();
+        return os;
+    }
+};
+
+/**
+ * Class FractionLeaf
+ *
+ * Description:
+ *      A fraction inside an expression, held by reference.
+ */
+template <typename T>
+class FractionLeaf : public FractionExpression<FractionLeaf<T>, T> {
+private:
+    const Fraction<T>& value;
+
+public:
+    explicit FractionLeaf(const Fraction<T>& fraction) : value(fraction) {}
+
+    template <typename S>
+    bool fused(S& num, S& den) const {
+        num = value.getNumerator();
+        den = value.getDenominator();
+        return true;
+    }
+
+    Fraction<T> eager() const { return value; }
+};
+
+/**
+ * Class FractionOperation
+ *
+ * Description:
+ *      One of + - * / applied to two subexpressions, which are held by
+ *      value (leaves are only references, so this stays small).
+ */
+template <char Op, typename L, typename R>
+class FractionOperation : public FractionExpression<FractionOperation<Op, L, R>, typename L::Integer> {
+private:
+    L left;
+    R right;
+
+public:
+    FractionOperation(const L& l, const R& r) : left(l), right(r) {}
+
+    /**
+     * fused
+     *
+     * Description:
+     *      Computes the unreduced value in S (T or Storage) with a positive
+     *      denominator.
+     *
+     * Returns:
+     *      bool - false if any step overflowed
+     *
+     * Throws:
+     *      invalid_argument - if the right side of a / is zero
+     */
+    template <typename S>
+    bool fused(S& num, S& den) const {
+        S n1, d1, n2, d2;
+        if (!left.fused(n1, d1) || !right.fused(n2, d2))
+            return false;
+        if constexpr (Op == '+' || Op == '-') {
+            if (d1 == d2) {
+                den = d1;
+                return !(Op == '+' ? __builtin_add_overflow(n1, n2, &num) : __builtin_sub_overflow(n1, n2, &num));
+            }
+            // Least common denominator rather than d1 * d2, so the numbers
+            // grow as slowly as the reduced value's would
+            S g = Fraction<S>::gcd(d1, d2);
+            S a, b;
+            return !__builtin_mul_overflow(n1, d2 / g, &a) && !__builtin_mul_overflow(n2, d1 / g, &b) &&
+                   !(Op == '+' ? __builtin_add_overflow(a, b, &num) : __builtin_sub_overflow(a, b, &num)) &&
+                   !__builtin_mul_overflow(d1 / g, d2, &den);
+        } else if constexpr (Op == '*') {
+            return !__builtin_mul_overflow(n1, n2, &num) && !__builtin_mul_overflow(d1, d2, &den);
+        } else {
+            if (n2 == 0) {
+                throw std::invalid_argument("Cannot divide by zero.");
+            }
+            if (__builtin_mul_overflow(n1, d2, &num) || __builtin_mul_overflow(d1, n2, &den))
+                return false;
+            if (den < 0)
+                return !__builtin_sub_overflow(S(0), num, &num) && !__builtin_sub_overflow(S(0), den, &den);
+            return true;
+        }
+    }
+
+    Fraction<typename L::Integer> eager() const {
+        if constexpr (Op == '+')
+            return left.eager() + right.eager();
+        else if constexpr (Op == '-')
+            return left.eager() - right.eager();
+        else if constexpr (Op == '*')
+            return left.eager() * right.eager();
+        else
+            return left.eager() / right.eager();
+    }
+};
+
+template <typename E>
+concept FractionNode = std::derived_from<E, FractionExpression<E, typename E::Integer>>;
+
+/**
+ * lazy
+ *
+ * Description:
+ *      Starts an expression: operators on the result build a tree that is
+ *      evaluated in one pass.
+ *
+ * Returns:
+ *      FractionLeaf<T> - the fraction as an expression
+ */
+template <typename T>
+FractionLeaf<T> lazy(const Fraction<T>& fraction) {
+    return FractionLeaf<T>(fraction);
+}
+
+// Fractions in an expression become leaves; subexpressions stay as they are
+template <typename E>
+const E& asFractionNode(const E& node)
+    requires FractionNode<E>
+{
+    return node;
+}
+
+template <typename T>
+FractionLeaf<T> asFractionNode(const Fraction<T>& fraction) {
+    return FractionLeaf<T>(fraction);
+}
+
+template <typename E, typename T>
+concept FractionOperand = FractionNode<E> || std::same_as<E, Fraction<T>>;
+
+template <typename E>
+struct FractionOperandInteger {};
+
+template <FractionNode E>
+struct FractionOperandInteger<E> {
+    using type = typename E::Integer;
+};
+
+template <typename T>
+struct FractionOperandInteger<Fraction<T>> {
+    using type = T;
+};
+
+// At least one side must already be an expression, so plain Fraction
+// arithmetic is left alone, and both sides must use the same integer type
+template <typename L, typename R>
+concept FractionOperands =
+    (FractionNode<L> || FractionNode<R>) &&
+    std::same_as<typename FractionOperandInteger<L>::type, typename FractionOperandInteger<R>::type> &&
+    FractionOperand<L, typename FractionOperandInteger<L>::type> &&
+    FractionOperand<R, typename FractionOperandInteger<R>::type>;
+
+template <char Op, typename L, typename R>
+auto makeFractionOperation(const L& l, const R& r) {
+    using Left = std::remove_cvref_t<decltype(asFractionNode(l))>;
+    using Right = std::remove_cvref_t<decltype(asFractionNode(r))>;
+    return FractionOperation<Op, Left, Right>(asFractionNode(l), asFractionNode(r));
+}
+
+template <typename L, typename R>
+    requires FractionOperands<L, R>
+auto operator+(const L& l, const R& r) {
+    return makeFractionOperation<'+'>(l, r);
+}
+
+template <typename L, typename R>
+    requires FractionOperands<L, R>
+auto operator-(const L& l, const R& r) {
+    return makeFractionOperation<'-'>(l, r);
+}
+
+template <typename L, typename R>
+    requires FractionOperands<L, R>
+auto operator*(const L& l, const R& r) {
+    return makeFractionOperation<'*'>(l, r);
+}
+
+template <typename L, typename R>
+    requires FractionOperands<L, R>
+auto operator/(const L& l, const R& r) {
+    return makeFractionOperation<'/'>(l, r);
+}
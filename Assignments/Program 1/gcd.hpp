@@ -0,0 +1,305 @@
+/*****************************************************************************
+*
+*  Author:           Jesus Mendoza
+*  Email:            jesus.kyx.mendoza11@gmail.com
+*  Label:            Program 1 - Fraction Class
+*  Title:            GCD Kernels
+*  Course:           CMPS 2143
+*  Semester:         Fall 2024
+*
+*  Description:
+*        Greatest common divisor of two unsigned integers (32, 64 or 128
+*        bits), which every Fraction operation needs when it reduces its
+*        result. There are four kernels:
+*
+*            Euclid  a % b until b is 0. Few steps, but each one is a
+*                    hardware division (20-90 cycles), and for 128 bits a
+*                    library call.
+*            Binary  Stein's algorithm: strip factors of two with a count
+*                    trailing zeros instruction, then subtract the smaller
+*                    number from the larger. Only shifts, subtractions and
+*                    conditional moves, at about one bit per step.
+*            Hybrid  Binary, except that when one number is at least 256
+*                    times the other, a single a % b takes it down at once
+*                    (binary steps would remove one bit at a time).
+*            Table   Binary until both numbers are below 64, then a
+*                    64 x 64 table lookup for the rest.
+*
+*        For 128 bits, the binary kernels switch to 64-bit arithmetic as
+*        soon as both numbers fit in 64 bits.
+*
+*        Which kernel is fastest depends on the width and on the machine,
+*        so each width has its own choice, GcdEngine<U>::method:
+*
+*            build time  defaultGcdMethod<U>() picks Binary for 32 and 64
+*                        bits and Hybrid for 128 bits (measured with
+*                        gcd_bench.cpp). Compiling with
+*                        -DFRACTION_GCD_METHOD=GcdMethod::Euclid (or any
+*                        other method) forces one kernel for every width.
+*            run time    GcdEngine<U>::calibrate() times every kernel on
+*                        this CPU and keeps the fastest. setMethod() sets
+*                        it directly.
+*
+*  Usage:
+*        std::uint64_t g = GcdEngine<std::uint64_t>::gcd(a, b);
+*        GcdEngine<unsigned __int128>::calibrate();
+*
+*  Files:
+*        gcd.hpp        : This header.
+*        gcd_bench.cpp  : Compares the kernels.
+*
+*****************************************************************************/
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <random>
+#include <utility>
+#include <vector>
+
+enum class GcdMethod { Euclid, Binary, Hybrid, Table };
+
+constexpr const char* GCD_METHOD_NAMES[] = {"euclid", "binary", "hybrid", "table"};
+
+// Trailing zero bits of a non-zero value
+template <typename U>
+constexpr int countTrailingZeros(U value) {
+    if constexpr (sizeof(U) <= sizeof(unsigned)) {
+        return __builtin_ctz(static_cast<unsigned>(value));
+    } else if constexpr (sizeof(U) <= sizeof(unsigned long long)) {
+        return __builtin_ctzll(static_cast<unsigned long long>(value));
+    } else {
+        auto low = static_cast<unsigned long long>(value);
+        return low ? __builtin_ctzll(low) : 64 + __builtin_ctzll(static_cast<unsigned long long>(value >> 64));
+    }
+}
+
+template <typename U>
+constexpr U gcdEuclid(U a, U b) {
+    while (b != 0) {
+        U temp = b;
+        b = a % b;
+        a = temp;
+    }
+    return a;
+}
+
+// Stein's binary GCD. The trailing zeros of a - b are counted while min
+// and |a - b| are computed, so a step is only a few cycles long.
+template <typename U>
+constexpr U gcdBinary(U a, U b) {
+    if (a == 0)
+        return b;
+    if (b == 0)
+        return a;
+    int shift = countTrailingZeros(a | b);  // Common factors of two
+    int zeros = countTrailingZeros(a);
+    b >>= countTrailingZeros(b);
+    while (a != 0) {
+        a >>= zeros;
+        if constexpr (sizeof(U) > 8) {
+            if ((a | b) >> 64 == 0)
+                return U(gcdBinary<std::uint64_t>(std::uint64_t(a), std::uint64_t(b))) << shift;
+        }
+        U difference = b - a;
+        // b - a and a - b have the same trailing zeros; the top bit only
+        // keeps the count defined once the loop is about to end
+        zeros = countTrailingZeros(difference | U(1) << (8 * sizeof(U) - 1));
+        // min(a, b) and |a - b| from a mask rather than an if, which the
+        // compiler keeps as a branch that mispredicts half the time
+        U mask = U(0) - U(b < a);
+        b = a + (difference & mask);
+        a = (difference ^ mask) - mask;
+    }
+    return b << shift;
+}
+
+template <typename U>
+constexpr U gcdHybrid(U a, U b) {
+    if (a == 0)
+        return b;
+    if (b == 0)
+        return a;
+    int shift = countTrailingZeros(a | b);
+    a >>= countTrailingZeros(a);
+    b >>= countTrailingZeros(b);
+    while (true) {
+        if constexpr (sizeof(U) > 8) {
+            if ((a | b) >> 64 == 0)
+                return U(gcdHybrid<std::uint64_t>(std::uint64_t(a), std::uint64_t(b))) << shift;
+        }
+        U difference = b - a;
+        U mask = U(0) - U(b < a);
+        U low = a + (difference & mask);
+        U distance = (difference ^ mask) - mask;
+        if (distance >> 8 >= low)
+            distance %= low;  // Quotient of 256 or more: one division instead of 8+ steps
+        if (distance == 0)
+            return low << shift;
+        a = low;
+        b = distance >> countTrailingZeros(distance);
+    }
+}
+
+constexpr int GCD_TABLE_SIZE = 64;
+
+constexpr std::array<std::array<std::uint8_t, GCD_TABLE_SIZE>, GCD_TABLE_SIZE> makeGcdTable() {
+    std::array<std::array<std::uint8_t, GCD_TABLE_SIZE>, GCD_TABLE_SIZE> table{};
+    for (unsigned a = 0; a < GCD_TABLE_SIZE; ++a)
+        for (unsigned b = 0; b < GCD_TABLE_SIZE; ++b)
+            table[a][b] = static_cast<std::uint8_t>(gcdEuclid(a, b));
+    return table;
+}
+
+inline constexpr auto GCD_TABLE = makeGcdTable();
+
+// Binary steps until both numbers are below GCD_TABLE_SIZE, then a lookup
+template <typename U>
+constexpr U gcdTable(U a, U b) {
+    if ((a | b) < GCD_TABLE_SIZE)
+        return GCD_TABLE[static_cast<int>(a)][static_cast<int>(b)];
+    if (a == 0)
+        return b;
+    if (b == 0)
+        return a;
+    int shift = countTrailingZeros(a | b);
+    a >>= countTrailingZeros(a);
+    b >>= countTrailingZeros(b);
+    while ((a | b) >= GCD_TABLE_SIZE) {
+        if constexpr (sizeof(U) > 8) {
+            if ((a | b) >> 64 == 0)
+                return U(gcdTable<std::uint64_t>(std::uint64_t(a), std::uint64_t(b))) << shift;
+        }
+        U difference = b - a;
+        U mask = U(0) - U(b < a);
+        U low = a + (difference & mask);
+        U distance = (difference ^ mask) - mask;
+        if (distance == 0)
+            return low << shift;
+        a = low;
+        b = distance >> countTrailingZeros(distance);
+    }
+    return static_cast<U>(GCD_TABLE[static_cast<int>(a)][static_cast<int>(b)]) << shift;
+}
+
+// Build-time choice of kernel for each width
+template <typename U>
+constexpr GcdMethod defaultGcdMethod() {
+#ifdef FRACTION_GCD_METHOD
+    return FRACTION_GCD_METHOD;
+#else
+    // A 128-bit step is several instructions, so skipping many of them with
+    // one a % b pays off when the numbers are far apart, as fraction sums
+    // often are
+    return sizeof(U) > 8 ? GcdMethod::Hybrid : GcdMethod::Binary;
+#endif
+}
+
+template <GcdMethod Method, typename U>
+constexpr U gcdWith(U a, U b) {
+    if constexpr (Method == GcdMethod::Euclid)
+        return gcdEuclid(a, b);
+    else if constexpr (Method == GcdMethod::Binary)
+        return gcdBinary(a, b);
+    else if constexpr (Method == GcdMethod::Hybrid)
+        return gcdHybrid(a, b);
+    else
+        return gcdTable(a, b);
+}
+
+/**
+ * Class GcdEngine
+ *
+ * Description:
+ *      The GCD kernel used for one unsigned width. The choice is a
+ *      per-width atomic variable, read with a relaxed load, so a run-time
+ *      switch costs one predictable branch per call and setMethod() or
+ *      calibrate() may run while other threads are computing GCDs.
+ *
+ * Public Methods:
+ *      - static U gcd(U a, U b)
+ *      - static GcdMethod getMethod()
+ *      - static void setMethod(GcdMethod method)
+ *      - static GcdMethod calibrate()
+ *
+ * Private Members:
+ *      - static std::atomic<GcdMethod> method
+ */
+template <typename U>
+class GcdEngine {
+private:
+    static inline std::atomic<GcdMethod> method{defaultGcdMethod<U>()};
+
+    template <GcdMethod Method>
+    static double timeKernel(const std::vector<std::pair<U, U>>& inputs, U& sink) {
+        auto start = std::chrono::steady_clock::now();
+        for (const auto& [a, b] : inputs)
+            sink += gcdWith<Method>(a, b);
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+public:
+    static U gcd(U a, U b) {
+        switch (method.load(std::memory_order_relaxed)) {
+        case GcdMethod::Euclid:
+            return gcdEuclid(a, b);
+        case GcdMethod::Hybrid:
+            return gcdHybrid(a, b);
+        case GcdMethod::Table:
+            return gcdTable(a, b);
+        default:
+            return gcdBinary(a, b);
+        }
+    }
+
+    static GcdMethod getMethod() { return method.load(std::memory_order_relaxed); }
+    static void setMethod(GcdMethod chosen) { method.store(chosen, std::memory_order_relaxed); }
+
+    /**
+     * calibrate
+     *
+     * Description:
+     *      Times every kernel on this CPU with fraction-like inputs (a mix of
+     *      full-width, small and far-apart pairs), best of five runs each,
+     *      and switches to the fastest. Takes a few milliseconds.
+     *
+     * Returns:
+     *      GcdMethod - the kernel now in use
+     */
+    static GcdMethod calibrate() {
+        std::mt19937_64 random(0x6763640a);
+        std::vector<std::pair<U, U>> inputs(4096);
+        for (std::size_t i = 0; i < inputs.size(); ++i) {
+            int bitsA = 1 + static_cast<int>(random() % (8 * sizeof(U)));
+            int bitsB = 1 + static_cast<int>(random() % (8 * sizeof(U)));
+            U a = static_cast<U>(random()), b = static_cast<U>(random());
+            if constexpr (sizeof(U) > 8) {
+                a = a << 64 | random();
+                b = b << 64 | random();
+            }
+            inputs[i] = {static_cast<U>(a >> (8 * sizeof(U) - bitsA) | 1),
+                         static_cast<U>(b >> (8 * sizeof(U) - bitsB))};
+        }
+
+        U sink = 0;
+        double best[4] = {1e9, 1e9, 1e9, 1e9};
+        for (int run = 0; run < 5; ++run) {
+            best[0] = std::min(best[0], timeKernel<GcdMethod::Euclid>(inputs, sink));
+            best[1] = std::min(best[1], timeKernel<GcdMethod::Binary>(inputs, sink));
+            best[2] = std::min(best[2], timeKernel<GcdMethod::Hybrid>(inputs, sink));
+            best[3] = std::min(best[3], timeKernel<GcdMethod::Table>(inputs, sink));
+        }
+        int fastest = 0;
+        for (int k = 1; k < 4; ++k)
+            if (best[k] < best[fastest])
+                fastest = k;
+        volatile U keep = sink;  // Keeps the timed calls from being optimized away
+        (void)keep;
+        method.store(static_cast<GcdMethod>(fastest), std::memory_order_relaxed);
+        return static_cast<GcdMethod>(fastest);
+    }
+};
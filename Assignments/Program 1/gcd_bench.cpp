@@ -0,0 +1,190 @@
+/*****************************************************************************
+*
+*  Author:           Jesus Mendoza
+*  Email:            jesus.kyx.mendoza11@gmail.com
+*  Label:            Program 1 - Fraction Class
+*  Title:            GCD Kernel Benchmark
+*  Course:           CMPS 2143
+*  Semester:         Fall 2024
+*
+*  Description:
+*        Times the four GCD kernels in gcd.hpp for 32, 64 and 128-bit
+*        operands on four kinds of input:
+*
+*            uniform     both numbers random over the full width
+*            small       both numbers below 256
+*            fibonacci   consecutive Fibonacci numbers near the top of the
+*                        width, where every Euclid quotient is 1 (its worst
+*                        case)
+*            unbalanced  one full-width number and one below 2^16, as in
+*                        reducing a big numerator over a small denominator
+*
+*        Every input set is fixed by --seed. Each cell is the median over
+*        --reps runs of the time per GCD. Before timing, every kernel's
+*        results are checked against Euclid. At the end, calibrate() picks
+*        a kernel for each width on this CPU, which is compared with the
+*        build-time default.
+*
+*  Usage:
+*        g++ -std=c++20 -O2 -march=native gcd_bench.cpp -o gcd_bench
+*        ./gcd_bench [--reps n] [--count n] [--seed n]
+*
+*  Files:
+*        gcd_bench.cpp  : This benchmark.
+*        gcd.hpp        : The kernels.
+*
+*****************************************************************************/
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "gcd.hpp"
+
+using namespace std;
+
+using u128 = unsigned __int128;
+
+const char* INPUT_KINDS[] = {"uniform", "small", "fibonacci", "unbalanced"};
+
+template <typename U>
+U randomBits(mt19937_64& random, int bits) {
+    U value = static_cast<U>(random());
+    if constexpr (sizeof(U) > 8)
+        value = value << 64 | random();
+    return bits >= static_cast<int>(8 * sizeof(U)) ? value : value & ((U(1) << bits) - 1);
+}
+
+template <typename U>
+vector<pair<U, U>> makeInputs(int kind, size_t count, mt19937_64& random) {
+    constexpr int BITS = 8 * sizeof(U);
+    vector<U> fibonacci = {0, 1};
+    while (fibonacci.back() <= numeric_limits<U>::max() - fibonacci[fibonacci.size() - 2])
+        fibonacci.push_back(fibonacci.back() + fibonacci[fibonacci.size() - 2]);
+
+    vector<pair<U, U>> inputs(count);
+    for (auto& [a, b] : inputs) {
+        switch (kind) {
+        case 0:
+            a = randomBits<U>(random, BITS);
+            b = randomBits<U>(random, BITS);
+            break;
+        case 1:
+            a = randomBits<U>(random, 8);
+            b = randomBits<U>(random, 8);
+            break;
+        case 2: {
+            // One of the top eight pairs, so the loop length is not constant
+            size_t top = fibonacci.size() - 1 - random() % 8;
+            a = fibonacci[top];
+            b = fibonacci[top - 1];
+            break;
+        }
+        default:
+            a = randomBits<U>(random, BITS);
+            b = randomBits<U>(random, 16) | 1;
+            break;
+        }
+    }
+    return inputs;
+}
+
+// Median nanoseconds per GCD over reps runs
+template <GcdMethod Method, typename U>
+double timeKernel(const vector<pair<U, U>>& inputs, int reps) {
+    vector<double> samples;
+    U sink = 0;
+    for (int rep = 0; rep < reps; ++rep) {
+        auto start = chrono::steady_clock::now();
+        for (const auto& [a, b] : inputs)
+            sink += gcdWith<Method>(a, b);
+        samples.push_back(chrono::duration<double, nano>(chrono::steady_clock::now() - start).count() / inputs.size());
+    }
+    volatile U keep = sink;
+    (void)keep;
+    nth_element(samples.begin(), samples.begin() + reps / 2, samples.end());
+    return samples[reps / 2];
+}
+
+template <GcdMethod Method, typename U>
+bool agreesWithEuclid(const vector<pair<U, U>>& inputs) {
+    for (const auto& [a, b] : inputs)
+        if (gcdWith<Method>(a, b) != gcdEuclid(a, b) || gcdWith<Method>(b, a) != gcdEuclid(a, b))
+            return false;
+    return true;
+}
+
+template <typename U>
+bool benchWidth(size_t count, int reps, uint64_t seed) {
+    bool correct = true;
+    for (int kind = 0; kind < 4; ++kind) {
+        mt19937_64 random(seed + kind);
+        vector<pair<U, U>> inputs = makeInputs<U>(kind, count, random);
+
+        if (!agreesWithEuclid<GcdMethod::Binary>(inputs) || !agreesWithEuclid<GcdMethod::Hybrid>(inputs) ||
+            !agreesWithEuclid<GcdMethod::Table>(inputs)) {
+            cout << "Error: kernels disagree on " << 8 * sizeof(U) << "-bit " << INPUT_KINDS[kind] << " inputs"
+                 << endl;
+            correct = false;
+            continue;
+        }
+
+        double times[4] = {timeKernel<GcdMethod::Euclid>(inputs, reps), timeKernel<GcdMethod::Binary>(inputs, reps),
+                           timeKernel<GcdMethod::Hybrid>(inputs, reps), timeKernel<GcdMethod::Table>(inputs, reps)};
+        int fastest = static_cast<int>(min_element(times, times + 4) - times);
+
+        cout << left << setw(9) << (to_string(8 * sizeof(U)) + "-bit") << setw(12) << INPUT_KINDS[kind] << right
+             << fixed << setprecision(1);
+        for (int k = 0; k < 4; ++k)
+            cout << setw(10) << times[k] << (k == fastest ? "*" : " ");
+        cout << endl;
+    }
+    return correct;
+}
+
+template <typename U>
+void reportChoice() {
+    GcdMethod builtIn = GcdEngine<U>::getMethod();
+    GcdMethod measured = GcdEngine<U>::calibrate();
+    cout << setw(3) << 8 * sizeof(U) << "-bit: default " << GCD_METHOD_NAMES[static_cast<int>(builtIn)]
+         << ", calibrate() picked " << GCD_METHOD_NAMES[static_cast<int>(measured)] << endl;
+}
+
+int main(int argc, char* argv[]) {
+    int reps = 15;
+    size_t count = 4096;
+    uint64_t seed = 0x474344;
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--reps") == 0 && i + 1 < argc)
+            reps = max(1, atoi(argv[++i]));
+        else if (strcmp(argv[i], "--count") == 0 && i + 1 < argc)
+            count = max(1, atoi(argv[++i]));
+        else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc)
+            seed = strtoull(argv[++i], nullptr, 10);
+    }
+
+    cout << "Nanoseconds per GCD, median of " << reps << " runs over " << count << " pairs (* = fastest)" << endl;
+    cout << left << setw(21) << "width    input" << right;
+    for (const char* name : GCD_METHOD_NAMES)
+        cout << setw(10) << name << " ";
+    cout << endl;
+
+    bool correct = benchWidth<uint32_t>(count, reps, seed);
+    correct = benchWidth<uint64_t>(count, reps, seed) && correct;
+    correct = benchWidth<u128>(count, reps, seed) && correct;
+
+    cout << endl;
+    reportChoice<uint32_t>();
+    reportChoice<uint64_t>();
+    reportChoice<u128>();
+    return correct ? 0 : 1;
+}
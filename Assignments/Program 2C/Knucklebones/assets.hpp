@@ -0,0 +1,219 @@
+/*****************************************************************************
+*
+*  Author:           Jesus Mendoza
+*  Email:            jesus.kyx.mendoza11@gmail.com
+*  Label:            Program 2C - Knucklebones Game
+*  Title:            Game Assets
+*  Course:           CMPS 2143
+*  Semester:         Fall 2024
+*
+*  Description:
+*        Textures and the font used by the game, loaded once at start-up.
+*        The 6 dice faces and the 24 animation frames are packed into one
+*        texture (an atlas) and sprites pick their image with a texture
+*        rectangle.
+*
+*        By default the assets are read from images/ and Arial.ttf next to
+*        the working directory. Compiled with KNUCKLEBONES_EMBEDDED_ASSETS,
+*        they come from embedded_assets.hpp instead, which embed_assets.cpp
+*        generates: the atlas and logo already decoded to RGBA pixels and
+*        the font as raw TTF bytes. The game then opens no files at all and
+*        decodes no images, and runs from any directory.
+*
+*  Usage:
+*        AssetManager assets;
+*        if (!assets.load()) return;
+*        sprite.setTexture(assets.getAtlas());
+*        sprite.setTextureRect(assets.faceRect(6));
+*
+*****************************************************************************/
+
+#pragma once
+
+#include <SFML/Graphics.hpp>
+
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#ifdef KNUCKLEBONES_EMBEDDED_ASSETS
+#include "embedded_assets.hpp"
+#endif
+
+const int DICE_FACES = 6;
+const int DICE_FRAMES = 24;
+
+// Image files in atlas order: faces 1-6, then animation frames 1-24
+inline std::vector<std::string> diceImageFiles() {
+    std::vector<std::string> files;
+    for (int value = 1; value <= DICE_FACES; ++value)
+        files.push_back("images/" + std::to_string(value) + ".png");
+    for (int i = 1; i <= DICE_FRAMES; ++i) {
+        std::ostringstream filename;
+        filename << "images/frame_" << std::setw(3) << std::setfill('0') << i << ".png";
+        files.push_back(filename.str());
+    }
+    return files;
+}
+
+/**
+ * Function Name: packDiceAtlas
+ *
+ * Description:
+ *      Reads the dice images and copies them into one image, six per row,
+ *      recording where each one went. Used by the game and, ahead of time,
+ *      by embed_assets.cpp.
+ *
+ * Params:
+ *      - sf::Image& sheet : Receives the packed images.
+ *      - sf::IntRect faces[] : Receives the rectangle of each face, value 1 first.
+ *      - sf::IntRect frames[] : Receives the rectangle of each animation frame.
+ *
+ * Returns:
+ *      - bool : false if an image is missing (the error is printed).
+ */
+inline bool packDiceAtlas(sf::Image& sheet, sf::IntRect faces[DICE_FACES], sf::IntRect frames[DICE_FRAMES]) {
+    std::vector<std::string> files = diceImageFiles();
+    std::vector<sf::Image> images(files.size());
+    unsigned cellWidth = 0, cellHeight = 0;
+    for (std::size_t i = 0; i < files.size(); ++i) {
+        if (!images[i].loadFromFile(files[i])) {
+            std::cerr << "Error loading image " << files[i] << std::endl;
+            return false;
+        }
+        cellWidth = std::max(cellWidth, images[i].getSize().x);
+        cellHeight = std::max(cellHeight, images[i].getSize().y);
+    }
+
+    const unsigned perRow = 6;
+    unsigned rows = (files.size() + perRow - 1) / perRow;
+    sheet.create(perRow * cellWidth, rows * cellHeight, sf::Color::Transparent);
+    for (std::size_t i = 0; i < images.size(); ++i) {
+        unsigned x = (i % perRow) * cellWidth;
+        unsigned y = (i / perRow) * cellHeight;
+        sheet.copy(images[i], x, y);
+
+        sf::IntRect rect(x, y, images[i].getSize().x, images[i].getSize().y);
+        if (i < DICE_FACES)
+            faces[i] = rect;
+        else
+            frames[i - DICE_FACES] = rect;
+    }
+    return true;
+}
+
+/**
+ * Class Name: AssetManager
+ *
+ * Description:
+ *      Loads every image and the font once, at start-up. The dice faces and
+ *      animation frames share one texture, so changing a face or an
+ *      animation frame never touches the disk or decodes a PNG.
+ *
+ * Public Methods:
+ *      - bool load()
+ *      - const sf::Texture& getAtlas() const
+ *      - sf::IntRect faceRect(int value) const
+ *      - sf::IntRect frameRect(int frame) const
+ *      - const sf::Texture& getLogo() const
+ *      - const sf::Font& getFont() const
+ *
+ * Private Members:
+ *      - sf::Texture atlas
+ *      - sf::IntRect faces[6]
+ *      - sf::IntRect frames[24]
+ *      - sf::Texture logo
+ *      - sf::Font font
+ *
+ * Usage:
+ *      AssetManager assets;
+ *      if (!assets.load()) return;          // Reads every file exactly once
+ *      sprite.setTexture(assets.getAtlas());
+ *      sprite.setTextureRect(assets.faceRect(6));
+ */
+class AssetManager {
+    sf::Texture atlas;                // Dice faces and animation frames
+    sf::IntRect faces[DICE_FACES];    // Atlas rectangle of each face, value 1 first
+    sf::IntRect frames[DICE_FRAMES];  // Atlas rectangle of each animation frame
+    sf::Texture logo;
+    sf::Font font;
+
+#ifdef KNUCKLEBONES_EMBEDDED_ASSETS
+    // Uploads pixels that were decoded at build time
+    static bool loadPixels(sf::Texture& texture, unsigned width, unsigned height, const unsigned char* pixels) {
+        if (!texture.create(width, height))
+            return false;
+        texture.update(pixels);
+        return true;
+    }
+
+    bool loadEmbedded() {
+        // SFML reads the font lazily, so the bytes must outlive it; they are static
+        if (!font.loadFromMemory(EMBEDDED_FONT, sizeof(EMBEDDED_FONT))) {
+            std::cerr << "Error loading embedded font!" << std::endl;
+            return false;
+        }
+        if (!loadPixels(logo, EMBEDDED_LOGO_WIDTH, EMBEDDED_LOGO_HEIGHT, EMBEDDED_LOGO) ||
+            !loadPixels(atlas, EMBEDDED_ATLAS_WIDTH, EMBEDDED_ATLAS_HEIGHT, EMBEDDED_ATLAS)) {
+            std::cerr << "Error creating embedded textures!" << std::endl;
+            return false;
+        }
+        for (int i = 0; i < DICE_FACES; ++i)
+            faces[i] = sf::IntRect(EMBEDDED_FACES[i][0], EMBEDDED_FACES[i][1], EMBEDDED_FACES[i][2], EMBEDDED_FACES[i][3]);
+        for (int i = 0; i < DICE_FRAMES; ++i)
+            frames[i] = sf::IntRect(EMBEDDED_FRAMES[i][0], EMBEDDED_FRAMES[i][1], EMBEDDED_FRAMES[i][2], EMBEDDED_FRAMES[i][3]);
+        return true;
+    }
+#endif
+
+    bool loadFiles() {
+        if (!font.loadFromFile("Arial.ttf")) {
+            std::cerr << "Error loading font!" << std::endl;
+            return false;
+        }
+        if (!logo.loadFromFile("images/knuckleboneslogo.jpg")) {
+            std::cerr << "Error loading logo!" << std::endl;
+            return false;
+        }
+
+        sf::Image sheet;
+        if (!packDiceAtlas(sheet, faces, frames))
+            return false;
+        if (!atlas.loadFromImage(sheet)) {
+            std::cerr << "Error creating dice texture atlas!" << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+public:
+        /**
+     * Public : load
+     *
+     * Description:
+     *      Loads the font, the logo and the dice atlas, from the embedded
+     *      data when the game was built with it and from disk otherwise.
+     *
+     * Params:
+     *      - None
+     *
+     * Returns:
+     *      - bool : false if anything fails to load (the error is printed).
+     */
+    bool load() {
+#ifdef KNUCKLEBONES_EMBEDDED_ASSETS
+        return loadEmbedded();
+#else
+        return loadFiles();
+#endif
+    }
+
+    const sf::Texture& getAtlas() const { return atlas; }
+    sf::IntRect faceRect(int value) const { return faces[value - 1]; }
+    sf::IntRect frameRect(int frame) const { return frames[frame]; }
+    const sf::Texture& getLogo() const { return logo; }
+    const sf::Font& getFont() const { return font; }
+};
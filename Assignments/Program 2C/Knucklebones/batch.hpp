@@ -0,0 +1,236 @@
+/*****************************************************************************
+*
+*  Author:           Jesus Mendoza
+*  Email:            jesus.kyx.mendoza11@gmail.com
+*  Label:            Program 2C - Knucklebones Game
+*  Title:            Lane-Parallel Batch Engine
+*  Course:           CMPS 2143
+*  Semester:         Fall 2024
+*
+*  Description:
+*        Plays many independent random games at once for score studies.
+*        The state is stored as a structure of arrays: one vector holds the
+*        packed grid (see engine.hpp) of player 1 in every lane, one holds
+*        player 2's, and four more hold every lane's random generator. Each
+*        operation (rolling, picking a column, placing a die, scoring) then
+*        runs on all lanes with a few vector instructions.
+*
+*        Under the standard rules every game lasts exactly 18 moves, so all
+*        lanes stay on the same turn and no lane ever waits for another.
+*        The batch engine only plays the standard rules (see Rules).
+*
+*        The vectors use GCC/Clang vector extensions, so the compiler picks
+*        the instructions: 16 lanes with AVX-512, 8 with AVX2. placeDice
+*        needs a different shift in every lane, which only AVX2 and later
+*        have, so older targets, other compilers and builds with
+*        KNUCKLEBONES_NO_SIMD use a scalar fallback with one lane.
+*        KNUCKLEBONES_BATCH_LANES overrides the width, but it should match
+*        the vector registers: GCC splits wider vectors into slow
+*        piecewise code (32 lanes on AVX-512 runs slower than scalar).
+*
+*        Lookup tables do not vectorize (they need gathers), so columns are
+*        worked out arithmetically:
+*            height = number of nonzero 3-bit slots
+*            score  = sum over the three slots of v * (1 + [v == other1] + [v == other2])
+*        which equals sum of value * count * count, the Grid::calculateScore()
+*        rule, since empty slots contribute 0.
+*
+*        Each lane rolls with its own xoshiro128** generator, which needs
+*        only 32-bit operations. Values in a range are taken from the top 24
+*        bits by multiply and shift, which has a bias under 1 in 2^21.
+*
+*  Usage:
+*        GameBatch batch(seed);
+*        batch.playRandom();                  // BATCH_LANES games
+*        LaneInt scores = GameBatch::scoreGrid(batch.grids[0]);
+*
+*****************************************************************************/
+
+#pragma once
+
+#include <cstdint>
+
+#include "engine.hpp"
+
+#if (defined(__GNUC__) || defined(__clang__)) && !defined(KNUCKLEBONES_NO_SIMD) && \
+    (defined(__AVX2__) || defined(KNUCKLEBONES_BATCH_LANES))
+#define KNUCKLEBONES_BATCH_SIMD 1
+// Everything here is inline, so the note that vector arguments are passed
+// differently with and without AVX does not matter
+#pragma GCC diagnostic ignored "-Wpsabi"
+#ifndef KNUCKLEBONES_BATCH_LANES
+#ifdef __AVX512F__
+#define KNUCKLEBONES_BATCH_LANES 16
+#else
+#define KNUCKLEBONES_BATCH_LANES 8
+#endif
+#endif
+constexpr int BATCH_LANES = KNUCKLEBONES_BATCH_LANES;
+typedef std::int32_t LaneInt __attribute__((vector_size(4 * BATCH_LANES)));
+typedef std::uint32_t LaneUInt __attribute__((vector_size(4 * BATCH_LANES)));
+
+// Comparisons give -1 (all bits set) where true and 0 where false
+inline LaneInt laneEq(LaneInt a, LaneInt b) { return a == b; }
+inline LaneInt laneLt(LaneInt a, LaneInt b) { return a < b; }
+#else
+constexpr int BATCH_LANES = 1;
+typedef std::int32_t LaneInt;
+typedef std::uint32_t LaneUInt;
+
+inline LaneInt laneEq(LaneInt a, LaneInt b) { return -static_cast<LaneInt>(a == b); }
+inline LaneInt laneLt(LaneInt a, LaneInt b) { return -static_cast<LaneInt>(a < b); }
+#endif
+
+// mask ? a : b, lane by lane, for masks from laneEq/laneLt
+inline LaneInt laneSelect(LaneInt mask, LaneInt a, LaneInt b) { return (mask & a) | (~mask & b); }
+
+inline LaneInt laneBroadcast(std::int32_t value) { return LaneInt{} + value; }
+
+inline std::int32_t laneGet(const LaneInt& v, int lane) {
+#ifdef KNUCKLEBONES_BATCH_SIMD
+    return v[lane];
+#else
+    (void)lane;
+    return v;
+#endif
+}
+
+inline void laneSet(LaneInt& v, int lane, std::int32_t value) {
+#ifdef KNUCKLEBONES_BATCH_SIMD
+    v[lane] = value;
+#else
+    (void)lane;
+    v = value;
+#endif
+}
+
+inline void laneSet(LaneUInt& v, int lane, std::uint32_t value) {
+#ifdef KNUCKLEBONES_BATCH_SIMD
+    v[lane] = value;
+#else
+    (void)lane;
+    v = value;
+#endif
+}
+
+/**
+ * Class Name: GameBatch
+ *
+ * Description:
+ *      BATCH_LANES games of random player against random player, advanced
+ *      together one move at a time.
+ *
+ * Public Methods:
+ *      - explicit GameBatch(std::uint64_t seed)
+ *      - LaneInt roll()
+ *      - LaneInt below(LaneInt bound)
+ *      - LaneInt randomLegalColumn(LaneInt grid)
+ *      - void playRandom()
+ *      - static LaneInt columnOf(LaneInt grid, int col)
+ *      - static LaneInt columnHeight(LaneInt column)
+ *      - static LaneInt scoreColumn(LaneInt column)
+ *      - static LaneInt scoreGrid(LaneInt grid)
+ *      - static LaneInt placeDice(LaneInt grid, LaneInt col, LaneInt value)
+ *
+ * Public Members:
+ *      - LaneInt grids[2]
+ *      - LaneUInt rng[4]
+ */
+struct GameBatch {
+    LaneInt grids[2];  // Packed grid of each player, one game per lane
+    LaneUInt rng[4];   // xoshiro128** state, one generator per lane
+
+    // Gives every lane its own generator, seeded through splitmix64
+    explicit GameBatch(std::uint64_t seed) {
+        grids[0] = grids[1] = LaneInt{};
+        std::uint64_t mix = seed;
+        for (int lane = 0; lane < BATCH_LANES; ++lane) {
+            for (int i = 0; i < 4; ++i)
+                laneSet(rng[i], lane, static_cast<std::uint32_t>(splitmix64(mix) >> 32));
+        }
+    }
+
+    // Next 32 random bits in every lane (xoshiro128**)
+    LaneUInt next() {
+        LaneUInt x = rng[1] * 5u;
+        LaneUInt result = ((x << 7) | (x >> 25)) * 9u;
+        LaneUInt t = rng[1] << 9;
+        rng[2] ^= rng[0];
+        rng[3] ^= rng[1];
+        rng[1] ^= rng[2];
+        rng[0] ^= rng[3];
+        rng[2] ^= t;
+        rng[3] = (rng[3] << 11) | (rng[3] >> 21);
+        return result;
+    }
+
+    // A value in [0, bound) in every lane; bound is at most 127 so the
+    // product stays below 2^31
+    LaneInt below(LaneInt bound) {
+        LaneInt top = (LaneInt)(next() >> 8);  // 24 random bits; vectors only allow C-style casts
+        return (top * bound) >> 24;
+    }
+
+    // A die (1-6) in every lane
+    LaneInt roll() { return below(laneBroadcast(6)) + 1; }
+
+    // The 9-bit packed column col of every lane's grid
+    static LaneInt columnOf(LaneInt grid, int col) { return (grid >> (COLUMN_BITS * col)) & COLUMN_MASK; }
+
+    // Dice in each packed column: dice stack from the bottom slot up
+    static LaneInt columnHeight(LaneInt column) {
+        LaneInt zero = LaneInt{};
+        return -(~laneEq(column & 7, zero)) - (~laneEq(column & (7 << 3), zero)) -
+               (~laneEq(column & (7 << 6), zero));
+    }
+
+    // Score of each packed column, the same as COLUMN_TABLES.score
+    static LaneInt scoreColumn(LaneInt column) {
+        LaneInt a = column & 7, b = (column >> 3) & 7, c = (column >> 6) & 7;
+        // Each match mask is -1, so subtracting it adds one copy of the value
+        return a * (1 - laneEq(a, b) - laneEq(a, c)) + b * (1 - laneEq(b, a) - laneEq(b, c)) +
+               c * (1 - laneEq(c, a) - laneEq(c, b));
+    }
+
+    // Score of each lane's grid, the same as Grid::calculateScore()
+    static LaneInt scoreGrid(LaneInt grid) {
+        return scoreColumn(columnOf(grid, 0)) + scoreColumn(columnOf(grid, 1)) + scoreColumn(columnOf(grid, 2));
+    }
+
+    // Drops value onto column col in every lane. The column must have room.
+    static LaneInt placeDice(LaneInt grid, LaneInt col, LaneInt value) {
+        LaneInt shift = col * COLUMN_BITS;
+        LaneInt column = (grid >> shift) & COLUMN_MASK;
+        LaneInt slot = columnHeight(column) * 3;
+        return grid | ((value << slot) << shift);
+    }
+
+    // A uniformly chosen column that is not full, in every lane. Every
+    // lane must have at least one open column.
+    LaneInt randomLegalColumn(LaneInt grid) {
+        LaneInt three = laneBroadcast(3);
+        LaneInt open0 = laneLt(columnHeight(columnOf(grid, 0)), three);
+        LaneInt open1 = laneLt(columnHeight(columnOf(grid, 1)), three);
+        LaneInt open2 = laneLt(columnHeight(columnOf(grid, 2)), three);
+        LaneInt count = -(open0 + open1 + open2);
+        LaneInt pick = below(count);  // Which of the open columns
+
+        // Walk the columns, counting open ones until the pick-th
+        LaneInt before1 = -open0;             // Open columns left of column 1
+        LaneInt before2 = before1 - open1;    // Open columns left of column 2
+        LaneInt col = laneSelect(open0 & laneEq(pick, LaneInt{}), LaneInt{}, three);
+        col = laneSelect(laneEq(col, three) & open1 & laneEq(pick, before1), laneBroadcast(1), col);
+        col = laneSelect(laneEq(col, three) & open2 & laneEq(pick, before2), laneBroadcast(2), col);
+        return col;
+    }
+
+    // Plays every lane's game from empty grids to the end
+    void playRandom() {
+        grids[0] = grids[1] = LaneInt{};
+        for (int turn = 0; turn < 18; ++turn) {
+            LaneInt& grid = grids[turn & 1];
+            LaneInt die = roll();
+            grid = placeDice(grid, randomLegalColumn(grid), die);
+        }
+    }
+};
@@ -0,0 +1,142 @@
+/*****************************************************************************
+*
+*  Author:           Jesus Mendoza
+*  Email:            jesus.kyx.mendoza11@gmail.com
+*  Label:            Program 2C - Knucklebones Game
+*  Title:            Batch Engine Benchmark
+*  Course:           CMPS 2143
+*  Semester:         Fall 2024
+*
+*  Description:
+*        Plays the same number of random games with the scalar engine
+*        (GameState, one game at a time) and with the lane-parallel batch
+*        engine, and compares games/second and the score statistics of the
+*        two. The statistics should agree to within sampling error, since
+*        both play uniformly random legal moves with fair dice.
+*
+*        With --check, every batch game's final grids are also rebuilt as
+*        Grid objects and the vector scores compared with calculateScore().
+*
+*  Usage:
+*        g++ -std=c++20 -O2 -march=native batch_bench.cpp -o batch_bench
+*        ./batch_bench [games] [--seed n] [--check]    (default 10000000)
+*
+*  Files:
+*        batch_bench.cpp  : This benchmark.
+*        batch.hpp        : Batch engine.
+*        engine.hpp       : Scalar engine.
+*
+*****************************************************************************/
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+
+#include "batch.hpp"
+#include "engine.hpp"
+
+using namespace std;
+
+// Totals over a run, for comparing the two engines
+struct RunStats {
+    long long games = 0;
+    long long wins1 = 0, wins2 = 0, draws = 0;
+    long long scoreSum = 0;  // Both players
+    double seconds = 0;
+
+    void add(int score1, int score2) {
+        games++;
+        scoreSum += score1 + score2;
+        if (score1 > score2)
+            wins1++;
+        else if (score2 > score1)
+            wins2++;
+        else
+            draws++;
+    }
+
+    void print(const char* name) const {
+        cout << setw(8) << name << fixed << setprecision(4) << "  mean score " << scoreSum / (2.0 * games)
+             << "  p1 wins " << static_cast<double>(wins1) / games << "  draws "
+             << static_cast<double>(draws) / games << setprecision(0) << "  " << games / seconds
+             << " games/second" << endl;
+    }
+};
+
+int main(int argc, char* argv[]) {
+    long long games = 10000000;
+    unsigned long long seed = 1;
+    bool check = false;
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc)
+            seed = strtoull(argv[++i], nullptr, 10);
+        else if (strcmp(argv[i], "--check") == 0)
+            check = true;
+        else
+            games = atoll(argv[i]);
+    }
+
+    // Scalar engine, one game at a time
+    RunStats scalar;
+    Dice dice(seed);
+    GameState state;
+    auto start = chrono::steady_clock::now();
+    for (long long g = 0; g < games; ++g) {
+        state.reset();
+        while (!state.isTerminal()) {
+            int die = dice.roll();
+            int legal[3];
+            int count = 0;
+            for (int col = 0; col < 3; ++col)
+                if (state.isLegal(col))
+                    legal[count++] = col;
+            state.applyMove(legal[dice.below(count)], die);
+        }
+        GameScores s = state.scores();
+        scalar.add(s.player1, s.player2);
+    }
+    scalar.seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    // Batch engine, BATCH_LANES games per step; scores are computed for
+    // all lanes at once and read out per lane for the statistics
+    RunStats batch;
+    GameBatch lanes(seed);
+    long long mismatches = 0;
+    start = chrono::steady_clock::now();
+    for (long long g = 0; g < games; g += BATCH_LANES) {
+        lanes.playRandom();
+        LaneInt score1 = GameBatch::scoreGrid(lanes.grids[0]);
+        LaneInt score2 = GameBatch::scoreGrid(lanes.grids[1]);
+        for (int lane = 0; lane < BATCH_LANES && g + lane < games; ++lane) {
+            batch.add(laneGet(score1, lane), laneGet(score2, lane));
+            if (check) {
+                for (int p = 0; p < 2; ++p) {
+                    Grid grid = Grid::fromPacked(static_cast<uint32_t>(laneGet(lanes.grids[p], lane)));
+                    int expected = grid.calculateScore();
+                    if (!grid.isFull() || expected != laneGet(p == 0 ? score1 : score2, lane))
+                        mismatches++;
+                }
+            }
+        }
+    }
+    batch.seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    cout << "Games: " << games << ", " << BATCH_LANES << " lanes"
+#ifdef KNUCKLEBONES_BATCH_SIMD
+         << " (vector extensions)"
+#else
+         << " (scalar fallback)"
+#endif
+         << endl;
+    scalar.print("scalar");
+    batch.print("batch");
+    cout << "Speedup: " << setprecision(2) << scalar.seconds / batch.seconds << "x" << endl;
+    if (check) {
+        cout << "Checked " << 2 * games << " grids against calculateScore(): " << mismatches << " mismatches"
+             << endl;
+        return mismatches == 0 ? 0 : 2;
+    }
+    return 0;
+}
@@ -0,0 +1,164 @@
+/*****************************************************************************
+*
+*  Author:           Jesus Mendoza
+*  Email:            jesus.kyx.mendoza11@gmail.com
+*  Label:            Program 2C - Knucklebones Game
+*  Title:            Canonical Grids and Perfect-Hash Ranking
+*  Course:           CMPS 2143
+*  Semester:         Fall 2024
+*
+*  Description:
+*        Many grids play exactly alike. A column's score only depends on
+*        which dice it holds, not their order, and where a new die lands
+*        only depends on how many there are. The order of the three columns
+*        does not matter either. So a grid is fully described by a multiset
+*        of three column multisets.
+*
+*        A column holds one of 84 multisets (1 empty, 6 with one die, 21
+*        with two, 56 with three). These are numbered by size first, so
+*        adding a die always gives a higher number. A canonical grid lists
+*        its three column numbers in order, and the combinatorial number
+*        system maps those sorted triples onto 0 .. 102339 with no gaps.
+*        That is 170 times fewer slots than the 259^3 ordered grids, so a
+*        table over canonical grids fits in cache.
+*
+*        Adding a die raises one column number, which gives a higher
+*        canonical rank, so tables can be filled from the last rank down.
+*
+*  Usage:
+*        Grid canon = canonicalize(grid);       // Representative grid
+*        std::uint32_t r = canonicalRank(grid); // 0 .. CANONICAL_GRIDS - 1
+*        Grid back = unrankCanonical(r);        // Same as canon
+*
+*****************************************************************************/
+
+#pragma once
+
+#include <cstdint>
+
+#include "engine.hpp"
+
+// Number of distinct column multisets and of canonical grids
+constexpr int COLUMN_MULTISETS = 84;
+constexpr std::uint32_t CANONICAL_GRIDS = 102340;  // C(84 + 2, 3)
+
+// Binomial coefficient for the small arguments used here
+constexpr std::uint32_t choose(int n, int k) {
+    if (k < 0 || n < k)
+        return 0;
+    std::uint32_t result = 1;
+    for (int i = 1; i <= k; ++i)
+        result = result * (n - k + i) / i;
+    return result;
+}
+
+// Column lookup tables for canonical forms
+struct MultisetTables {
+    std::uint8_t rank[COLUMN_STATES];            // Multiset number of a packed column (0xFF if invalid)
+    std::uint16_t column[COLUMN_MULTISETS];      // Sorted packed column for each number
+};
+
+constexpr MultisetTables makeMultisetTables() {
+    MultisetTables tables{};
+    const int offset[4] = {0, 1, 7, 28};  // First number for each column height
+    for (int column = 0; column < COLUMN_STATES; ++column) {
+        int height = columnHeight(column);
+        bool valid = (column >> (3 * height)) == 0;  // Nothing above the stack
+        for (int slot = 0; slot < height; ++slot)
+            valid = valid && columnSlot(column, slot) <= 6;
+        if (!valid) {
+            tables.rank[column] = 0xFF;
+            continue;
+        }
+
+        // Sort the dice, smallest first
+        int dice[3] = {0, 0, 0};
+        for (int slot = 0; slot < height; ++slot)
+            dice[slot] = columnSlot(column, slot);
+        for (int i = 0; i < height; ++i)
+            for (int j = i + 1; j < height; ++j)
+                if (dice[j] < dice[i]) {
+                    int t = dice[i];
+                    dice[i] = dice[j];
+                    dice[j] = t;
+                }
+
+        // Combinatorial number system for multisets of size `height`
+        int rank = offset[height];
+        unsigned sorted = 0;
+        for (int i = 0; i < height; ++i) {
+            rank += choose(dice[i] - 1 + i, i + 1);
+            sorted |= static_cast<unsigned>(dice[i]) << (3 * i);
+        }
+
+        tables.rank[column] = static_cast<std::uint8_t>(rank);
+        tables.column[rank] = static_cast<std::uint16_t>(sorted);
+    }
+    return tables;
+}
+
+inline constexpr MultisetTables MULTISET_TABLES = makeMultisetTables();
+
+// Binomial terms of canonicalRank(), so ranking needs no arithmetic loops
+struct RankTerms {
+    std::uint32_t second[COLUMN_MULTISETS];  // C(m + 1, 2)
+    std::uint32_t third[COLUMN_MULTISETS];   // C(m + 2, 3)
+};
+
+constexpr RankTerms makeRankTerms() {
+    RankTerms terms{};
+    for (int m = 0; m < COLUMN_MULTISETS; ++m) {
+        terms.second[m] = choose(m + 1, 2);
+        terms.third[m] = choose(m + 2, 3);
+    }
+    return terms;
+}
+
+inline constexpr RankTerms RANK_TERMS = makeRankTerms();
+
+// Multiset number (0-83) of one column of a grid
+inline int columnMultiset(const Grid& grid, int col) {
+    return MULTISET_TABLES.rank[grid.column(col)];
+}
+
+// The three column numbers of a grid, sorted smallest first
+inline void sortedMultisets(const Grid& grid, int m[3]) {
+    m[0] = columnMultiset(grid, 0);
+    m[1] = columnMultiset(grid, 1);
+    m[2] = columnMultiset(grid, 2);
+    if (m[1] < m[0]) { int t = m[0]; m[0] = m[1]; m[1] = t; }
+    if (m[2] < m[1]) { int t = m[1]; m[1] = m[2]; m[2] = t; }
+    if (m[1] < m[0]) { int t = m[0]; m[0] = m[1]; m[1] = t; }
+}
+
+// Representative of a grid's class: columns sorted, dice sorted in each
+inline Grid canonicalize(const Grid& grid) {
+    int m[3];
+    sortedMultisets(grid, m);
+    return Grid::fromPacked(MULTISET_TABLES.column[m[0]] |
+                            MULTISET_TABLES.column[m[1]] << COLUMN_BITS |
+                            static_cast<std::uint32_t>(MULTISET_TABLES.column[m[2]]) << (2 * COLUMN_BITS));
+}
+
+// Dense rank of a grid's class, 0 .. CANONICAL_GRIDS - 1
+inline std::uint32_t canonicalRank(const Grid& grid) {
+    int m[3];
+    sortedMultisets(grid, m);
+    return m[0] + RANK_TERMS.second[m[1]] + RANK_TERMS.third[m[2]];
+}
+
+// Canonical grid with the given rank (inverse of canonicalRank)
+inline Grid unrankCanonical(std::uint32_t rank) {
+    int m[3];
+    for (int i = 2; i >= 0; --i) {
+        // Largest value whose binomial term still fits in what is left
+        int v = 0;
+        while (choose(v + 1 + i, i + 1) <= rank)
+            v++;
+        rank -= choose(v + i, i + 1);
+        m[i] = v;
+    }
+    return Grid::fromPacked(MULTISET_TABLES.column[m[0]] |
+                            MULTISET_TABLES.column[m[1]] << COLUMN_BITS |
+                            static_cast<std::uint32_t>(MULTISET_TABLES.column[m[2]]) << (2 * COLUMN_BITS));
+}
@@ -0,0 +1,130 @@
+/*****************************************************************************
+*
+*  Author:           Jesus Mendoza
+*  Email:            jesus.kyx.mendoza11@gmail.com
+*  Label:            Program 2C - Knucklebones Game
+*  Title:            Per-Column Expected Value Tables
+*  Course:           CMPS 2143
+*  Semester:         Fall 2024
+*
+*  Description:
+*        Lookup tables, built at compile time from scoreColumn() (the
+*        Grid::calculateScore() rule for one column), that say what a die is
+*        worth in each column. Every table is indexed by a packed column
+*        (see engine.hpp) and, where it matters, the die:
+*
+*            gain[c][d]        points gained right now by placing d in c
+*            expected[c]       expected final score of c if its empty
+*                              cells are filled with fair random dice
+*            placeValue[c][d]  expected[c with d] - expected[c]: the gain
+*                              now plus what d does for the column's future
+*            cancelValue[c][d] expected[c] - expected[c without d]: what an
+*                              opponent's column c loses when d cancels
+*                              its matching dice
+*
+*        expected[] is filled from full columns down: a full column is worth
+*        its score, and any other column the average over the six dice of
+*        the column one die taller.
+*
+*        tableColumn() plays the column with the highest placeValue, plus
+*        cancelValue of the opponent's column when cancellation is on, so
+*        it chooses with three pairs of loads and no search. That makes it
+*        a reasonable player by itself and a fast rollout policy for MCTS.
+*
+*  Usage:
+*        int col = tableColumn(state, die);
+*        float v = COLUMN_VALUES.placeValue[grid.column(col)][die];
+*
+*****************************************************************************/
+
+#pragma once
+
+#include <cstdint>
+
+#include "engine.hpp"
+
+// Per-column value tables indexed by a packed column
+struct ColumnValueTables {
+    std::int8_t gain[COLUMN_STATES][7];      // Score change from placing a die now
+    float expected[COLUMN_STATES];           // Expected final column score
+    float placeValue[COLUMN_STATES][7];      // Change in expected score from placing a die
+    float cancelValue[COLUMN_STATES][7];     // Expected score a die cancels from this column
+};
+
+constexpr ColumnValueTables makeColumnValueTables() {
+    ColumnValueTables tables{};
+
+    // Full columns first, then each height from their taller neighbours
+    for (int height = 3; height >= 0; --height) {
+        for (int column = 0; column < COLUMN_STATES; ++column) {
+            if (columnHeight(column) != height)
+                continue;
+            if (height == 3) {
+                tables.expected[column] = static_cast<float>(scoreColumn(column));
+                continue;
+            }
+            float sum = 0;
+            for (int die = 1; die <= 6; ++die)
+                sum += tables.expected[column | die << (3 * height)];
+            tables.expected[column] = sum / 6;
+        }
+    }
+
+    for (int column = 0; column < COLUMN_STATES; ++column) {
+        int height = columnHeight(column);
+        for (int die = 1; die <= 6; ++die) {
+            if (height < 3) {
+                unsigned placed = static_cast<unsigned>(column) | static_cast<unsigned>(die) << (3 * height);
+                tables.gain[column][die] = static_cast<std::int8_t>(scoreColumn(placed) - scoreColumn(column));
+                tables.placeValue[column][die] = tables.expected[placed] - tables.expected[column];
+            }
+            tables.cancelValue[column][die] =
+                tables.expected[column] - tables.expected[removeFromColumn(column, die)];
+        }
+    }
+    return tables;
+}
+
+inline constexpr ColumnValueTables COLUMN_VALUES = makeColumnValueTables();
+
+// Table value of placing die in one column for the side to move
+inline float columnValue(const GameState& state, int col, int die) {
+    int side = state.sideToMove();
+    float value = COLUMN_VALUES.placeValue[state.grids[side].column(col)][die];
+    if (state.rules.cancellation)
+        value += COLUMN_VALUES.cancelValue[state.grids[1 - side].column(col)][die];
+    return value;
+}
+
+/**
+ * Function Name: tableColumn
+ *
+ * Description:
+ *      Picks the legal column with the highest table value, breaking ties
+ *      by the points gained right now.
+ *
+ * Params:
+ *      - const GameState& state : Position with the player to move.
+ *      - int die : The value to place (1-6).
+ *
+ * Returns:
+ *      - int : The column to play (0-2).
+ */
+inline int tableColumn(const GameState& state, int die) {
+    const Grid& own = state.grids[state.sideToMove()];
+    int best = -1;
+    float bestValue = 0;
+    int bestGain = 0;
+    for (int col = 0; col < 3; ++col) {
+        if (own.isColumnFull(col))
+            continue;
+        float value = columnValue(state, col, die);
+        int gain = COLUMN_VALUES.gain[own.column(col)][die];
+        if (best < 0 || value > bestValue || (value == bestValue && gain > bestGain)) {
+            best = col;
+            bestValue = value;
+            bestGain = gain;
+        }
+    }
+    return best;
+}
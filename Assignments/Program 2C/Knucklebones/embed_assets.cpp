@@ -0,0 +1,113 @@
+/*****************************************************************************
+*
+*  Author:           Jesus Mendoza
+*  Email:            jesus.kyx.mendoza11@gmail.com
+*  Label:            Program 2C - Knucklebones Game
+*  Title:            Asset Embedding Tool
+*  Course:           CMPS 2143
+*  Semester:         Fall 2024
+*
+*  Description:
+*        Build step that turns the game's images and font into a C++ header
+*        so they can be compiled into the game. The dice images are packed
+*        into the same atlas the game would build at run time, and the atlas
+*        and logo are stored as decoded RGBA pixels, ready to upload to a
+*        texture. The font is stored as its TTF bytes, which SFML loads
+*        with loadFromMemory().
+*
+*  Usage:
+*        g++ -std=c++20 -O2 embed_assets.cpp -o embed_assets -lsfml-graphics -lsfml-system
+*        ./embed_assets [output]           (default embedded_assets.hpp)
+*        g++ -std=c++20 -DKNUCKLEBONES_EMBEDDED_ASSETS knucklebones.cpp ...
+*
+*        Run it from the directory holding images/ and Arial.ttf.
+*
+*  Files:
+*        embed_assets.cpp     : This tool.
+*        assets.hpp           : Atlas layout shared with the game.
+*        embedded_assets.hpp  : Generated output.
+*
+*****************************************************************************/
+
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "assets.hpp"
+
+using namespace std;
+
+// Writes bytes as an array initializer, 24 per line
+void writeBytes(ostream& out, const string& name, const unsigned char* data, size_t size) {
+    out << "alignas(4) inline const unsigned char " << name << "[" << size << "] = {";
+    char number[8];
+    for (size_t i = 0; i < size; ++i) {
+        if (i % 24 == 0)
+            out << "\n   ";
+        snprintf(number, sizeof(number), " %u,", data[i]);
+        out << number;
+    }
+    out << "\n};\n\n";
+}
+
+void writeRects(ostream& out, const string& name, const sf::IntRect* rects, int count) {
+    out << "inline constexpr int " << name << "[" << count << "][4] = {\n";
+    for (int i = 0; i < count; ++i)
+        out << "    {" << rects[i].left << ", " << rects[i].top << ", " << rects[i].width << ", "
+            << rects[i].height << "},\n";
+    out << "};\n\n";
+}
+
+void writeImage(ostream& out, const string& name, const sf::Image& image) {
+    sf::Vector2u size = image.getSize();
+    out << "inline constexpr unsigned " << name << "_WIDTH = " << size.x << ";\n";
+    out << "inline constexpr unsigned " << name << "_HEIGHT = " << size.y << ";\n";
+    writeBytes(out, name, image.getPixelsPtr(), static_cast<size_t>(size.x) * size.y * 4);
+}
+
+int main(int argc, char* argv[]) {
+    string outputPath = argc > 1 ? argv[1] : "embedded_assets.hpp";
+
+    sf::Image atlas;
+    sf::IntRect faces[DICE_FACES];
+    sf::IntRect frames[DICE_FRAMES];
+    if (!packDiceAtlas(atlas, faces, frames))
+        return 1;
+
+    sf::Image logo;
+    if (!logo.loadFromFile("images/knuckleboneslogo.jpg")) {
+        cerr << "Error loading logo!" << endl;
+        return 1;
+    }
+
+    ifstream fontFile("Arial.ttf", ios::binary);
+    if (!fontFile) {
+        cerr << "Error loading font!" << endl;
+        return 1;
+    }
+    vector<unsigned char> font((istreambuf_iterator<char>(fontFile)), istreambuf_iterator<char>());
+
+    ofstream out(outputPath);
+    if (!out) {
+        cerr << "Error writing " << outputPath << endl;
+        return 1;
+    }
+    out << "// Generated by embed_assets.cpp from images/ and Arial.ttf. Do not edit.\n"
+        << "#pragma once\n\n";
+    writeImage(out, "EMBEDDED_ATLAS", atlas);
+    writeRects(out, "EMBEDDED_FACES", faces, DICE_FACES);
+    writeRects(out, "EMBEDDED_FRAMES", frames, DICE_FRAMES);
+    writeImage(out, "EMBEDDED_LOGO", logo);
+    writeBytes(out, "EMBEDDED_FONT", font.data(), font.size());
+    if (!out) {
+        cerr << "Error writing " << outputPath << endl;
+        return 1;
+    }
+
+    cout << "Wrote " << outputPath << ": atlas " << atlas.getSize().x << "x" << atlas.getSize().y << ", logo "
+         << logo.getSize().x << "x" << logo.getSize().y << ", font " << font.size() << " bytes" << endl;
+    return 0;
+}
@@ -0,0 +1,596 @@
+/*****************************************************************************
+*
+*  Author:           Jesus Mendoza
+*  Email:            jesus.kyx.mendoza11@gmail.com
+*  Label:            Program 2C - Knucklebones Game
+*  Title:            Headless Knucklebones Rules Engine
+*  Course:           CMPS 2143
+*  Semester:         Fall 2024
+*
+*  Description:
+*        The rules of Knucklebones with no dependency on SFML. The grid, the
+*        dice and the turn order live here so the same logic can drive the
+*        graphical game, the AI players and headless batch simulations.
+*
+*        Nothing in this file allocates: a whole game is a plain value type
+*        that can be copied, stored in arrays and replayed as fast as the
+*        CPU allows.
+*
+*  Usage:
+*        GameState state;
+*        Dice dice(seed);
+*        while (!state.isTerminal()) {
+*            int die = dice.roll();
+*            state.applyMove(col, die);   // col chosen by a player or AI
+*        }
+*        GameScores result = state.scores();
+*
+*****************************************************************************/
+
+#pragma once
+
+#include <cassert>
+#include <cstdint>
+#include <ctime>
+#include <span>
+
+// splitmix64 step: turns a seed into well-mixed 64-bit words. Used to
+// seed Dice and to fill constant hash tables at compile time.
+constexpr std::uint64_t splitmix64(std::uint64_t& state) {
+    std::uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+/**
+ * Class Name: Dice
+ *
+ * Description:
+ *      Simulates a dice roll to generate random values. Every Dice object
+ *      has its own xoshiro256** generator, so dice can be used from many
+ *      threads at once and the same seed always gives the same rolls.
+ *      Values are drawn with Lemire's multiply-and-reject method, which
+ *      has no modulo bias.
+ *
+ *      Dice also meets the C++ UniformRandomBitGenerator requirements, so
+ *      it can drive the <random> distributions and std::shuffle.
+ *
+ * Public Methods:
+ *      - Dice()
+ *      - Dice(std::uint64_t seed)
+ *      - int roll()
+ *      - void rollBatch(std::span<std::uint8_t> out)
+ *      - std::uint32_t below(std::uint32_t bound)
+ *      - std::uint64_t next()
+ *      - void jump()
+ *      - std::uint64_t getSeed() const
+ *
+ * Private Members:
+ *      - std::uint64_t s[4]
+ *      - std::uint64_t seed
+ *
+ * Usage:
+ *      Dice dice(42);            // Same seed, same rolls
+ *      int result = dice.roll(); // Roll the dice and get a value between 1 and 6
+ */
+class Dice {
+    std::uint64_t s[4];   // xoshiro256** state
+    std::uint64_t seed;   // Seed the state was built from
+
+    static std::uint64_t rotl(std::uint64_t x, int k) { return (x << k) | (x >> (64 - k)); }
+
+    // Maps 32 random bits onto [0, bound); `ok` is false when the value
+    // falls in the small biased range and must be drawn again
+    static std::uint32_t scale(std::uint32_t bits, std::uint32_t bound, std::uint32_t threshold, bool& ok) {
+        std::uint64_t m = static_cast<std::uint64_t>(bits) * bound;
+        ok = static_cast<std::uint32_t>(m) >= threshold;
+        return static_cast<std::uint32_t>(m >> 32);
+    }
+
+public:
+    typedef std::uint64_t result_type;
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return ~result_type(0); }
+
+        /**
+     * Public : Dice
+     *
+     * Description:
+     *      Initializes the random number generator for dice rolls. Without a
+     *      seed the current time is used, so every game is different.
+     *
+     * Params:
+     *      - std::uint64_t seed : Seed for a reproducible sequence of rolls.
+     *
+     * Returns:
+     *      - None
+     */
+    Dice() : Dice(static_cast<std::uint64_t>(time(0))) {}
+
+    explicit Dice(std::uint64_t seed) : seed(seed) {
+        std::uint64_t x = seed;
+        for (auto& word : s)
+            word = splitmix64(x);
+    }
+
+    // Next 64 random bits
+    std::uint64_t next() {
+        std::uint64_t result = rotl(s[1] * 5, 7) * 9;
+        std::uint64_t t = s[1] << 17;
+        s[2] ^= s[0];
+        s[3] ^= s[1];
+        s[1] ^= s[2];
+        s[0] ^= s[3];
+        s[2] ^= t;
+        s[3] = rotl(s[3], 45);
+        return result;
+    }
+
+    result_type operator()() { return next(); }
+
+    // Uniform value in [0, bound), bound > 0
+    std::uint32_t below(std::uint32_t bound) {
+        std::uint32_t threshold = (0u - bound) % bound;  // 2^32 mod bound
+        bool ok;
+        std::uint32_t value = scale(static_cast<std::uint32_t>(next() >> 32), bound, threshold, ok);
+        while (!ok)
+            value = scale(static_cast<std::uint32_t>(next() >> 32), bound, threshold, ok);
+        return value;
+    }
+
+        /**
+     * Public : roll
+     *
+     * Description:
+     *      Generates a random number between 1 and 6 to simulate a dice roll.
+     *
+     * Params:
+     *      - None
+     *
+     * Returns:
+     *      - int : The rolled dice value (1-6).
+     */
+    int roll() { return static_cast<int>(below(6)) + 1; }  // Returns a random value between 1 and 6
+
+        /**
+     * Public : rollBatch
+     *
+     * Description:
+     *      Fills a buffer with rolls (1-6). Each 64-bit output gives two
+     *      rolls, one from each half.
+     *
+     * Params:
+     *      - std::span<std::uint8_t> out : Buffer to fill.
+     *
+     * Returns:
+     *      - None
+     */
+    void rollBatch(std::span<std::uint8_t> out) {
+        const std::uint32_t threshold = (0u - 6u) % 6u;
+        std::size_t i = 0;
+        while (i < out.size()) {
+            std::uint64_t bits = next();
+            bool ok;
+            std::uint32_t value = scale(static_cast<std::uint32_t>(bits >> 32), 6, threshold, ok);
+            if (ok)
+                out[i++] = static_cast<std::uint8_t>(value + 1);
+            value = scale(static_cast<std::uint32_t>(bits), 6, threshold, ok);
+            if (ok && i < out.size())
+                out[i++] = static_cast<std::uint8_t>(value + 1);
+        }
+    }
+
+    // Advances the generator by 2^128 steps. Calling jump() k times on
+    // copies of one Dice gives k streams that never overlap, one per thread.
+    void jump() {
+        static const std::uint64_t JUMP[] = {0x180EC6D33CFD0ABAull, 0xD5A61266F0C9392Cull,
+                                             0xA9582618E03FC9AAull, 0x39ABDC4529B1661Cull};
+        std::uint64_t t[4] = {0, 0, 0, 0};
+        for (std::uint64_t word : JUMP) {
+            for (int b = 0; b < 64; ++b) {
+                if (word & (std::uint64_t(1) << b)) {
+                    t[0] ^= s[0];
+                    t[1] ^= s[1];
+                    t[2] ^= s[2];
+                    t[3] ^= s[3];
+                }
+                next();
+            }
+        }
+        s[0] = t[0];
+        s[1] = t[1];
+        s[2] = t[2];
+        s[3] = t[3];
+    }
+
+    // The seed this Dice was created with
+    std::uint64_t getSeed() const { return seed; }
+};
+
+/*
+ * Packed board encoding
+ *
+ * A cell holds 0 (empty) or a die value 1-6, which fits in 3 bits. Dice
+ * fall to the bottom of a column, so a column is a small stack of up to
+ * three values packed into 9 bits:
+ *
+ *      bits 0-2 : bottom cell (row 2)
+ *      bits 3-5 : middle cell (row 1)
+ *      bits 6-8 : top cell    (row 0)
+ *
+ * A whole grid is three columns side by side (column c at bit 9 * c), 27
+ * bits in one 32-bit word, so grids copy, compare and hash as integers.
+ * Every column has one of 512 encodings, which makes per-column lookup
+ * tables cheap.
+ */
+constexpr int COLUMN_BITS = 9;
+constexpr unsigned COLUMN_MASK = (1u << COLUMN_BITS) - 1;
+constexpr int COLUMN_STATES = 1 << COLUMN_BITS;
+
+// Die value in one slot of a packed column (slot 0 is the bottom)
+constexpr int columnSlot(unsigned column, int slot) {
+    return (column >> (3 * slot)) & 7;
+}
+
+// Scores one packed column with the original rule: each value counts
+// value * count, once for every matching die in the column
+constexpr int scoreColumn(unsigned column) {
+    int counts[8] = {0};  // Slot 0 counts empty cells, 7 is never a die
+    for (int slot = 0; slot < 3; ++slot)
+        counts[columnSlot(column, slot)]++;
+
+    int product = 0;
+    for (int i = 1; i <= 6; ++i)
+        product += counts[i] * i * counts[i];
+    return product;
+}
+
+// Number of dice stacked in a packed column
+constexpr int columnHeight(unsigned column) {
+    int height = 0;
+    while (height < 3 && columnSlot(column, height) != 0)
+        height++;
+    return height;
+}
+
+// Takes every die of one value out of a packed column. The dice above a
+// removed one fall down, so the column stays a stack from the bottom.
+constexpr unsigned removeFromColumn(unsigned column, int value) {
+    unsigned result = 0;
+    int height = 0;
+    for (int slot = 0; slot < 3; ++slot) {
+        int die = columnSlot(column, slot);
+        if (die != 0 && die != value)
+            result |= static_cast<unsigned>(die) << (3 * height++);
+    }
+    return result;
+}
+
+// Per-column lookup tables indexed by a packed column
+struct ColumnTables {
+    std::uint8_t score[COLUMN_STATES];       // Column score (at most 54)
+    std::uint8_t height[COLUMN_STATES];      // Dice in the column (0-3)
+    std::uint16_t without[COLUMN_STATES][7]; // Column with every die of a value removed
+};
+
+constexpr ColumnTables makeColumnTables() {
+    ColumnTables tables{};
+    for (int column = 0; column < COLUMN_STATES; ++column) {
+        tables.score[column] = static_cast<std::uint8_t>(scoreColumn(column));
+        tables.height[column] = static_cast<std::uint8_t>(columnHeight(column));
+        for (int value = 0; value <= 6; ++value)
+            tables.without[column][value] = static_cast<std::uint16_t>(removeFromColumn(column, value));
+    }
+    return tables;
+}
+
+inline constexpr ColumnTables COLUMN_TABLES = makeColumnTables();
+
+/**
+ * Class Name: Grid
+ *
+ * Description:
+ *      Represents a 3x3 grid for dice placement and score calculation.
+ *      Dice fall to the lowest free row of a column (row 2 is the bottom).
+ *      The grid is stored as one packed word (see the encoding above) and
+ *      scored with three lookups into COLUMN_TABLES.
+ *
+ *      Column scores and the total are kept up to date every time a column
+ *      changes, so score() is a single load. calculateScore() still does
+ *      the full recompute; building with -DKNUCKLEBONES_CHECK_SCORES makes
+ *      every change assert that the two agree.
+ *
+ * Public Methods:
+ *      - Grid()
+ *      - void clearGrid()
+ *      - bool placeDice(int col, int value)
+ *      - int removeValue(int col, int value)
+ *      - int calculateScore() const
+ *      - int score() const
+ *      - int columnScore(int col) const
+ *      - int at(int row, int col) const
+ *      - unsigned column(int col) const
+ *      - int columnHeight(int col) const
+ *      - bool isColumnFull(int col) const
+ *      - bool isFull() const
+ *      - std::uint32_t packed() const
+ *      - static Grid fromPacked(std::uint32_t bits)
+ *
+ * Private Members:
+ *      - std::uint32_t bits
+ *      - std::uint8_t scores[3]
+ *      - std::uint8_t total
+ *      - void setColumn(int col, unsigned column)
+ *      - void rescore()
+ *
+ * Usage:
+ *      Grid grid;
+ *      grid.placeDice(1, 5); // Place a dice with value 5 in column 1
+ *      int score = grid.score(); // Current score, kept up to date
+ *      std::uint32_t key = grid.packed(); // Whole board as one word
+ */
+class Grid {
+    std::uint32_t bits;      // Three packed 9-bit columns
+    std::uint8_t scores[3];  // Score of each column
+    std::uint8_t total;      // Sum of the column scores
+
+    // Replaces one column and updates its score and the total. Every
+    // change to the board goes through here.
+    void setColumn(int col, unsigned column) {
+        int shift = COLUMN_BITS * col;
+        bits = (bits & ~(COLUMN_MASK << shift)) | (column << shift);
+
+        int newScore = COLUMN_TABLES.score[column];
+        total = static_cast<std::uint8_t>(total - scores[col] + newScore);
+        scores[col] = static_cast<std::uint8_t>(newScore);
+
+#ifdef KNUCKLEBONES_CHECK_SCORES
+        assert(scores[col] == scoreColumn(this->column(col)));
+        assert(total == calculateScore());
+#endif
+    }
+
+    // Rebuilds the cached scores from the packed bits
+    void rescore() {
+        total = 0;
+        for (int col = 0; col < 3; ++col) {
+            scores[col] = COLUMN_TABLES.score[column(col)];
+            total = static_cast<std::uint8_t>(total + scores[col]);
+        }
+    }
+
+public:
+    Grid() { clearGrid(); }  // Initialize the grid
+
+    // Resets all cells in the grid to zero
+    void clearGrid() {
+        bits = 0;
+        scores[0] = scores[1] = scores[2] = 0;
+        total = 0;
+    }
+
+    // Places a dice value in the specified column if space is available
+    bool placeDice(int col, int value) {
+        int height = columnHeight(col);
+        if (height == 3)
+            return false;  // Column is full
+
+        setColumn(col, column(col) | static_cast<unsigned>(value) << (3 * height));
+        return true;
+    }
+
+    // Removes every die showing value from a column; the dice above fall
+    // down. Returns how many dice were removed.
+    int removeValue(int col, int value) {
+        unsigned before = column(col);
+        unsigned after = COLUMN_TABLES.without[before][value];
+        if (after == before)
+            return 0;
+        setColumn(col, after);
+        return COLUMN_TABLES.height[before] - COLUMN_TABLES.height[after];
+    }
+
+    // Calculates the total score based on grid values
+    int calculateScore() const {
+        return COLUMN_TABLES.score[column(0)] +
+               COLUMN_TABLES.score[column(1)] +
+               COLUMN_TABLES.score[column(2)];
+    }
+
+    // Current total score, maintained as the board changes
+    int score() const { return total; }
+
+    // Current score of a single column
+    int columnScore(int col) const { return scores[col]; }
+
+    // Returns the dice value at a cell (0 when the cell is empty)
+    int at(int row, int col) const { return columnSlot(column(col), 2 - row); }
+
+    // The packed 9-bit encoding of one column
+    unsigned column(int col) const { return (bits >> (COLUMN_BITS * col)) & COLUMN_MASK; }
+
+    // Number of dice in a column (0-3)
+    int columnHeight(int col) const { return COLUMN_TABLES.height[column(col)]; }
+
+    // A column is full once its top cell holds a die
+    bool isColumnFull(int col) const { return columnHeight(col) == 3; }
+
+    // True when all nine cells hold a die
+    bool isFull() const {
+        return isColumnFull(0) && isColumnFull(1) && isColumnFull(2);
+    }
+
+    // The whole grid as one word, suitable for hashing and table keys
+    std::uint32_t packed() const { return bits; }
+
+    // Rebuilds a grid from a word returned by packed()
+    static Grid fromPacked(std::uint32_t bits) {
+        Grid grid;
+        grid.bits = bits;
+        grid.rescore();
+        return grid;
+    }
+
+    bool operator==(const Grid& other) const { return bits == other.bits; }
+    bool operator!=(const Grid& other) const { return bits != other.bits; }
+};
+
+// Final (or current) score of both players, player 1 first
+struct GameScores {
+    int player1;
+    int player2;
+};
+
+/*
+ * Rule variants
+ *
+ * The standard rules are the ones this program has always played: the
+ * grids never interact and the game lasts until both are full (18 moves).
+ * The original game adds cancellation, where placing a die removes every
+ * die of the same value from the opponent's matching column, and ends as
+ * soon as either grid is full. The two switches are independent; under
+ * every variant the game also ends when the player to move has no open
+ * column, which with cancellation can happen before the other grid fills.
+ *
+ * Anything that relies on the grids being independent (the solved table,
+ * the batch engine) is only valid under the standard rules.
+ */
+struct Rules {
+    bool cancellation = false;   // A placed die removes the opponent's matching dice
+    bool endOnEitherFull = false; // The game ends when the first grid fills
+
+    static constexpr Rules standard() { return Rules{}; }
+    static constexpr Rules classic() { return Rules{true, true}; }
+
+    bool isStandard() const { return !cancellation && !endOnEitherFull; }
+
+    // Compact form used by record files: bit 0 cancellation, bit 1 ending
+    std::uint32_t bits() const { return (cancellation ? 1u : 0u) | (endOnEitherFull ? 2u : 0u); }
+    static Rules fromBits(std::uint32_t bits) { return Rules{(bits & 1) != 0, (bits & 2) != 0}; }
+    static constexpr std::uint32_t ALL_BITS = 3;
+
+    bool operator==(const Rules& other) const = default;
+};
+
+// What makeMove() changed, so unmakeMove() can put it back. A Grid is
+// 8 bytes (packed cells plus cached scores), so saving both whole is
+// cheaper than rescoring the changed columns on the way back.
+struct MoveUndo {
+    Grid own;       // Mover's grid before the move
+    Grid opponent;  // Opponent's grid before the move
+    int removed;    // Opponent dice cancelled by the move
+};
+
+/**
+ * Class Name: GameState
+ *
+ * Description:
+ *      Complete state of one game: both grids, the number of moves made
+ *      and the rules in force. Player 1 moves on even turns and player 2
+ *      on odd turns. Under the standard rules the game is over once both
+ *      grids are full (18 moves); see Rules for the variants.
+ *
+ *      makeMove() and unmakeMove() let a search walk the tree in place:
+ *      the undo record keeps both grids as they were, cached scores
+ *      included, so unmaking is two 8-byte stores.
+ *
+ * Public Methods:
+ *      - GameState(Rules rules = Rules())
+ *      - void reset()
+ *      - int sideToMove() const
+ *      - bool isLegal(int col) const
+ *      - bool applyMove(int col, int die)
+ *      - bool makeMove(int col, int die, MoveUndo& undo)
+ *      - void unmakeMove(const MoveUndo& undo)
+ *      - bool isTerminal() const
+ *      - GameScores scores() const
+ *      - std::uint64_t packed() const
+ *
+ * Public Members:
+ *      - Grid grids[2]
+ *      - int turn
+ *      - Rules rules
+ *
+ * Usage:
+ *      GameState state(Rules::classic());
+ *      MoveUndo undo;
+ *      state.makeMove(0, 4, undo);   // Player 1 puts a 4 in column 0
+ *      state.unmakeMove(undo);       // and takes it back
+ *      if (state.isTerminal()) { GameScores s = state.scores(); }
+ */
+struct GameState {
+    Grid grids[2];  // grids[0] belongs to player 1, grids[1] to player 2
+    int turn;       // Number of moves made so far
+    Rules rules;    // Variant being played
+
+    explicit GameState(Rules rules = Rules()) : turn(0), rules(rules) {}
+
+    // Starts a new game with empty grids and the same rules
+    void reset() {
+        grids[0].clearGrid();
+        grids[1].clearGrid();
+        turn = 0;
+    }
+
+    // Index (0 or 1) of the player whose move it is
+    int sideToMove() const { return turn & 1; }
+
+    // A move is legal if the column exists and still has room
+    bool isLegal(int col) const {
+        return col >= 0 && col < 3 && !grids[sideToMove()].isColumnFull(col);
+    }
+
+    // Places the rolled die for the side to move, cancels the opponent's
+    // matching dice if the rules say so, and passes the turn. Returns
+    // false (and changes nothing) if the move is illegal.
+    bool applyMove(int col, int die) {
+        if (!isLegal(col))
+            return false;
+        grids[sideToMove()].placeDice(col, die);
+        if (rules.cancellation)
+            grids[1 - sideToMove()].removeValue(col, die);
+        turn++;
+        return true;
+    }
+
+    // applyMove() that also fills in what is needed to take the move back
+    bool makeMove(int col, int die, MoveUndo& undo) {
+        int opponent = 1 - sideToMove();
+        undo.own = grids[sideToMove()];
+        undo.opponent = grids[opponent];
+        if (!applyMove(col, die))
+            return false;
+        undo.removed = undo.opponent.columnHeight(col) - grids[opponent].columnHeight(col);
+        return true;
+    }
+
+    // Takes back the last move made with makeMove()
+    void unmakeMove(const MoveUndo& undo) {
+        turn--;
+        grids[sideToMove()] = undo.own;
+        grids[1 - sideToMove()] = undo.opponent;
+    }
+
+    // The game ends when the player to move has no open column, or with
+    // Rules::endOnEitherFull as soon as either grid is full. Without
+    // cancellation grids fill in step, so the mover's grid is only full
+    // once both are.
+    bool isTerminal() const {
+        if (grids[sideToMove()].isFull())
+            return true;
+        return rules.endOnEitherFull && grids[1 - sideToMove()].isFull();
+    }
+
+    GameScores scores() const {
+        return {grids[0].score(), grids[1].score()};
+    }
+
+    // Both grids and the turn counter in one word: grid 1 in bits 0-26,
+    // grid 2 in bits 27-53 and the turn in the bits above
+    std::uint64_t packed() const {
+        return grids[0].packed() |
+               static_cast<std::uint64_t>(grids[1].packed()) << 27 |
+               static_cast<std::uint64_t>(turn) << 54;
+    }
+};
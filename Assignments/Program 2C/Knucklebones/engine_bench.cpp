@@ -0,0 +1,560 @@
+/*****************************************************************************
+*
+*  Author:           Jesus Mendoza
+*  Email:            jesus.kyx.mendoza11@gmail.com
+*  Label:            Program 2C - Knucklebones Game
+*  Title:            Engine Micro-Benchmarks
+*  Course:           CMPS 2143
+*  Semester:         Fall 2024
+*
+*  Description:
+*        Times the engine's hot paths so a performance change can be
+*        measured instead of guessed:
+*
+*            grid.placeDice       one placeDice() call
+*            grid.calculateScore  one full rescore of a grid
+*            grid.score           one read of the incrementally kept score
+*            dice.roll            one roll()
+*            dice.rollBatch       one roll from rollBatch()
+*            state.makeUnmake     one makeMove() plus unmakeMove()
+*            playout.standard     one random game, standard rules
+*            playout.classic      one random game, classic rules
+*            player.table         one tableColumn() decision
+*            search.emm           one expectiminimax node (depth 4)
+*            search.mcts          one MCTS playout
+*
+*        Every benchmark uses fixed seeds, so every run does the same work.
+*        Each one is first run for a warmup period, then its iteration count
+*        is calibrated so one sample takes --min-time milliseconds, and then
+*        --reps samples are timed. The report gives the median time per
+*        operation and a 95% confidence interval for the median taken from
+*        the order statistics of the samples, which needs no assumption
+*        about the shape of the timing distribution.
+*
+*        --json writes the results, with the compiler and machine, as JSON.
+*        --baseline reads such a file and compares: a benchmark counts as
+*        slower or faster only when the two confidence intervals do not
+*        overlap and the medians differ by more than --threshold percent.
+*        The exit code is 3 if anything got slower.
+*
+*  Usage:
+*        g++ -std=c++20 -O2 -march=native -pthread engine_bench.cpp -o engine_bench
+*        ./engine_bench [--filter text] [--reps n] [--min-time ms]
+*                       [--warmup ms] [--seed n] [--json file]
+*                       [--baseline file] [--threshold percent]
+*
+*        ./engine_bench --json baseline.json       (before a change)
+*        ./engine_bench --baseline baseline.json   (after it)
+*
+*  Files:
+*        engine_bench.cpp    : This benchmark suite.
+*        engine.hpp          : Grid, Dice and GameState.
+*        column_values.hpp   : Table player.
+*        expectiminimax.hpp  : Search measured by search.emm.
+*        mcts.hpp            : Search measured by search.mcts.
+*
+*****************************************************************************/
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "column_values.hpp"
+#include "engine.hpp"
+#include "expectiminimax.hpp"
+#include "mcts.hpp"
+
+using namespace std;
+using Clock = chrono::steady_clock;
+
+// Results are folded in here so the compiler cannot drop the work
+volatile uint64_t benchSink;
+
+// Makes the compiler assume memory changed, so a loop over the same inputs
+// cannot be computed once and reused across iterations
+inline void clobberMemory() { asm volatile("" ::: "memory"); }
+
+// One benchmark: run(iterations, sink) does the work and returns how many
+// operations it performed; prepare() runs untimed before every sample
+struct Benchmark {
+    string name;
+    string unit;  // What one operation is
+    function<void()> prepare;
+    function<long long(long long, uint64_t&)> run;
+};
+
+// Timing summary of one benchmark, in nanoseconds per operation
+struct BenchResult {
+    string name;
+    string unit;
+    double median = 0, low = 0, high = 0;  // Median and its 95% interval
+    double mean = 0, stddev = 0, best = 0;
+    long long iterations = 0;              // Per sample
+    int reps = 0;
+};
+
+// Times one sample; returns nanoseconds per operation
+double sample(Benchmark& bench, long long iterations, long long* opsOut = nullptr) {
+    if (bench.prepare)
+        bench.prepare();
+    uint64_t sink = 0;
+    auto start = Clock::now();
+    long long ops = bench.run(iterations, sink);
+    double ns = chrono::duration<double, nano>(Clock::now() - start).count();
+    benchSink = benchSink + sink;
+    if (opsOut)
+        *opsOut = ops;
+    return ops > 0 ? ns / static_cast<double>(ops) : 0;
+}
+
+BenchResult measure(Benchmark& bench, int reps, double minTimeMs, double warmupMs) {
+    // Warm up caches, branch predictors and clocks, and grow the iteration
+    // count until one sample takes minTimeMs
+    long long iterations = 1;
+    auto warmupEnd = Clock::now() + chrono::duration_cast<Clock::duration>(chrono::duration<double, milli>(warmupMs));
+    while (true) {
+        if (bench.prepare)
+            bench.prepare();
+        uint64_t sink = 0;
+        auto start = Clock::now();
+        bench.run(iterations, sink);
+        double ms = chrono::duration<double, milli>(Clock::now() - start).count();
+        benchSink = benchSink + sink;
+        if (ms >= minTimeMs && Clock::now() >= warmupEnd)
+            break;
+        if (ms < minTimeMs)
+            iterations = ms > 0.01 ? max(iterations + 1, static_cast<long long>(iterations * minTimeMs / ms * 1.1))
+                                   : iterations * 10;
+    }
+
+    vector<double> samples;
+    for (int r = 0; r < reps; ++r)
+        samples.push_back(sample(bench, iterations));
+    sort(samples.begin(), samples.end());
+
+    BenchResult result;
+    result.name = bench.name;
+    result.unit = bench.unit;
+    result.iterations = iterations;
+    result.reps = reps;
+    int n = static_cast<int>(samples.size());
+    result.median = n % 2 ? samples[n / 2] : (samples[n / 2 - 1] + samples[n / 2]) / 2;
+    result.best = samples.front();
+    for (double s : samples)
+        result.mean += s / n;
+    for (double s : samples)
+        result.stddev += (s - result.mean) * (s - result.mean);
+    result.stddev = n > 1 ? sqrt(result.stddev / (n - 1)) : 0;
+
+    // Distribution-free interval: the median lies between the j-th and
+    // k-th smallest samples with about 95% probability
+    double half = 1.96 * sqrt(static_cast<double>(n)) / 2;
+    int j = max(1, static_cast<int>(floor(n / 2.0 - half)));
+    int k = min(n, static_cast<int>(ceil(1 + n / 2.0 + half)));
+    result.low = samples[j - 1];
+    result.high = samples[k - 1];
+    return result;
+}
+
+// ---------------------------------------------------------------------
+// Inputs, built once from fixed seeds
+// ---------------------------------------------------------------------
+
+constexpr int INPUTS = 4096;  // Power of two, so indexes wrap with a mask
+
+struct BenchInputs {
+    uint8_t fillColumns[INPUTS];  // 9 legal columns per grid, back to back
+    uint8_t fillDice[INPUTS];
+    Grid grids[INPUTS];           // Random grids at every stage of a game
+    GameState states[INPUTS];     // Random positions with a legal move
+    uint8_t moveColumns[INPUTS];
+    uint8_t moveDice[INPUTS];
+};
+
+void buildInputs(BenchInputs& in, uint64_t seed) {
+    Dice dice(seed);
+    for (int start = 0; start + 9 <= INPUTS; start += 9) {
+        Grid grid;
+        for (int i = start; i < start + 9; ++i) {
+            int col;
+            do
+                col = static_cast<int>(dice.below(3));
+            while (grid.isColumnFull(col));
+            in.fillColumns[i] = static_cast<uint8_t>(col);
+            in.fillDice[i] = static_cast<uint8_t>(dice.roll());
+            grid.placeDice(col, in.fillDice[i]);
+        }
+    }
+
+    for (int i = 0; i < INPUTS; ++i) {
+        Grid grid;
+        int dice_count = static_cast<int>(dice.below(10));
+        for (int d = 0; d < dice_count; ++d) {
+            int col;
+            do
+                col = static_cast<int>(dice.below(3));
+            while (grid.isColumnFull(col));
+            grid.placeDice(col, dice.roll());
+        }
+        in.grids[i] = grid;
+
+        GameState state(i & 1 ? Rules::classic() : Rules::standard());
+        int moves = static_cast<int>(dice.below(17));
+        for (int m = 0; m < moves && !state.isTerminal(); ++m) {
+            int col;
+            do
+                col = static_cast<int>(dice.below(3));
+            while (!state.isLegal(col));
+            state.applyMove(col, dice.roll());
+        }
+        if (state.isTerminal())
+            state.reset();
+        in.states[i] = state;
+        int col;
+        do
+            col = static_cast<int>(dice.below(3));
+        while (!state.isLegal(col));
+        in.moveColumns[i] = static_cast<uint8_t>(col);
+        in.moveDice[i] = static_cast<uint8_t>(dice.roll());
+    }
+}
+
+int randomLegalColumn(const GameState& state, Dice& dice) {
+    int legal[3];
+    int count = 0;
+    for (int col = 0; col < 3; ++col)
+        if (state.isLegal(col))
+            legal[count++] = col;
+    return legal[dice.below(static_cast<uint32_t>(count))];
+}
+
+vector<Benchmark> makeBenchmarks(BenchInputs& in, uint64_t seed) {
+    vector<Benchmark> benches;
+
+    benches.push_back({"grid.placeDice", "call", nullptr, [&in](long long iterations, uint64_t& sink) {
+        Grid grid;
+        const long long fills = INPUTS / 9;
+        for (long long it = 0; it < iterations; ++it) {
+            int start = static_cast<int>(it % fills) * 9;
+            grid.clearGrid();
+            for (int i = start; i < start + 9; ++i)
+                grid.placeDice(in.fillColumns[i], in.fillDice[i]);
+            sink += grid.packed();
+        }
+        return iterations * 9;
+    }});
+
+    benches.push_back({"grid.calculateScore", "call", nullptr, [&in](long long iterations, uint64_t& sink) {
+        uint64_t sum = 0;
+        for (long long it = 0; it < iterations; ++it) {
+            clobberMemory();
+            for (int i = 0; i < INPUTS; ++i)
+                sum += static_cast<uint64_t>(in.grids[i].calculateScore());
+        }
+        sink += sum;
+        return iterations * INPUTS;
+    }});
+
+    benches.push_back({"grid.score", "call", nullptr, [&in](long long iterations, uint64_t& sink) {
+        uint64_t sum = 0;
+        for (long long it = 0; it < iterations; ++it) {
+            clobberMemory();
+            for (int i = 0; i < INPUTS; ++i)
+                sum += static_cast<uint64_t>(in.grids[i].score());
+        }
+        sink += sum;
+        return iterations * INPUTS;
+    }});
+
+    benches.push_back({"dice.roll", "roll", nullptr, [seed](long long iterations, uint64_t& sink) {
+        Dice dice(seed);
+        uint64_t sum = 0;
+        for (long long it = 0; it < iterations * 1024; ++it)
+            sum += static_cast<uint64_t>(dice.roll());
+        sink += sum;
+        return iterations * 1024;
+    }});
+
+    benches.push_back({"dice.rollBatch", "roll", nullptr, [seed](long long iterations, uint64_t& sink) {
+        Dice dice(seed);
+        uint8_t rolls[1024];
+        uint64_t sum = 0;
+        for (long long it = 0; it < iterations; ++it) {
+            dice.rollBatch(rolls);
+            sum += rolls[it & 1023];
+        }
+        sink += sum;
+        return iterations * 1024;
+    }});
+
+    benches.push_back({"state.makeUnmake", "move", nullptr, [&in](long long iterations, uint64_t& sink) {
+        uint64_t sum = 0;
+        for (long long it = 0; it < iterations; ++it) {
+            for (int i = 0; i < INPUTS; ++i) {
+                GameState& state = in.states[i];
+                MoveUndo undo;
+                state.makeMove(in.moveColumns[i], in.moveDice[i], undo);
+                sum += static_cast<uint64_t>(state.grids[0].score() - state.grids[1].score());
+                state.unmakeMove(undo);
+            }
+        }
+        sink += sum;
+        return iterations * INPUTS;
+    }});
+
+    for (Rules rules : {Rules::standard(), Rules::classic()}) {
+        string name = rules.isStandard() ? "playout.standard" : "playout.classic";
+        benches.push_back({name, "game", nullptr, [seed, rules](long long iterations, uint64_t& sink) {
+            Dice dice(seed);
+            GameState state(rules);
+            for (long long it = 0; it < iterations; ++it) {
+                state.reset();
+                while (!state.isTerminal()) {
+                    int die = dice.roll();
+                    state.applyMove(randomLegalColumn(state, dice), die);
+                }
+                sink += static_cast<uint64_t>(state.grids[0].score());
+            }
+            return iterations;
+        }});
+    }
+
+    benches.push_back({"player.table", "decision", nullptr, [&in](long long iterations, uint64_t& sink) {
+        uint64_t sum = 0;
+        for (long long it = 0; it < iterations; ++it) {
+            clobberMemory();
+            for (int i = 0; i < INPUTS; ++i)
+                sum += static_cast<uint64_t>(tableColumn(in.states[i], in.moveDice[i]));
+        }
+        sink += sum;
+        return iterations * INPUTS;
+    }});
+
+    // Searches get a fresh table before every sample, so every sample does
+    // the same work; building it is not timed
+    auto emm = make_shared<unique_ptr<ExpectiminimaxAI>>();
+    benches.push_back({"search.emm", "node", [emm] { *emm = make_unique<ExpectiminimaxAI>(0, 4, 16); },
+                       [&in, emm](long long iterations, uint64_t& sink) {
+        long long nodes = 0;
+        for (long long it = 0; it < iterations; ++it) {
+            int i = static_cast<int>((it * 97) & (INPUTS - 1));
+            sink += static_cast<uint64_t>((*emm)->chooseColumn(in.states[i], in.moveDice[i]));
+            nodes += (*emm)->lastStats().nodes;
+        }
+        return nodes;
+    }});
+
+    auto mcts = make_shared<unique_ptr<MctsAI>>();
+    benches.push_back({"search.mcts", "playout", [mcts, seed] { *mcts = make_unique<MctsAI>(0, 1, 200, 0.7, seed); },
+                       [&in, mcts](long long iterations, uint64_t& sink) {
+        long long playouts = 0;
+        for (long long it = 0; it < iterations; ++it) {
+            int i = static_cast<int>((it * 97) & (INPUTS - 1));
+            sink += static_cast<uint64_t>((*mcts)->chooseColumn(in.states[i], in.moveDice[i]));
+            playouts += (*mcts)->lastStats().playouts;
+        }
+        return playouts;
+    }});
+
+    return benches;
+}
+
+// ---------------------------------------------------------------------
+// Output
+// ---------------------------------------------------------------------
+
+string cpuName() {
+    ifstream cpuinfo("/proc/cpuinfo");
+    string line;
+    while (getline(cpuinfo, line)) {
+        if (line.rfind("model name", 0) == 0) {
+            size_t colon = line.find(':');
+            return colon == string::npos ? line : line.substr(colon + 2);
+        }
+    }
+    return "unknown";
+}
+
+string jsonEscape(const string& text) {
+    string out;
+    for (char c : text) {
+        if (c == '"' || c == '\\')
+            out += '\\';
+        out += c;
+    }
+    return out;
+}
+
+bool writeJson(const string& path, const vector<BenchResult>& results, uint64_t seed, int reps, double minTimeMs) {
+    ofstream out(path);
+    if (!out)
+        return false;
+    char date[32];
+    time_t now = time(nullptr);
+    strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", localtime(&now));
+    out << "{\n";
+    out << "  \"date\": \"" << date << "\",\n";
+    out << "  \"compiler\": \"" << jsonEscape(__VERSION__) << "\",\n";
+    out << "  \"cpu\": \"" << jsonEscape(cpuName()) << "\",\n";
+    out << "  \"threads\": " << thread::hardware_concurrency() << ",\n";
+    out << "  \"seed\": " << seed << ",\n";
+    out << "  \"reps\": " << reps << ",\n";
+    out << "  \"min_time_ms\": " << minTimeMs << ",\n";
+    out << "  \"benchmarks\": [\n";
+    out << setprecision(6);
+    for (size_t i = 0; i < results.size(); ++i) {
+        const BenchResult& r = results[i];
+        out << "    {\"name\": \"" << r.name << "\", \"unit\": \"" << r.unit << "\", \"ns_per_op\": " << r.median
+            << ", \"ci_low\": " << r.low << ", \"ci_high\": " << r.high << ", \"mean\": " << r.mean
+            << ", \"stddev\": " << r.stddev << ", \"best\": " << r.best << ", \"iterations\": " << r.iterations
+            << ", \"reps\": " << r.reps << "}" << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    out << "  ]\n}\n";
+    return static_cast<bool>(out);
+}
+
+// Reads back the benchmarks of a file written by writeJson(); only the
+// fields used for comparison are read
+bool readBaseline(const string& path, map<string, BenchResult>& baseline) {
+    ifstream in(path);
+    if (!in)
+        return false;
+    stringstream text;
+    text << in.rdbuf();
+    string json = text.str();
+
+    auto number = [&json](size_t object, size_t end, const string& key) {
+        size_t at = json.find("\"" + key + "\":", object);
+        return at < end ? strtod(json.c_str() + at + key.size() + 3, nullptr) : 0.0;
+    };
+    size_t at = json.find("\"benchmarks\"");
+    while (at != string::npos && (at = json.find('{', at)) != string::npos) {
+        size_t end = json.find('}', at);
+        if (end == string::npos)
+            break;
+        size_t nameAt = json.find("\"name\": \"", at);
+        if (nameAt < end) {
+            nameAt += 9;
+            BenchResult r;
+            r.name = json.substr(nameAt, json.find('"', nameAt) - nameAt);
+            r.median = number(at, end, "ns_per_op");
+            r.low = number(at, end, "ci_low");
+            r.high = number(at, end, "ci_high");
+            baseline[r.name] = r;
+        }
+        at = end;
+    }
+    return !baseline.empty();
+}
+
+// Time per operation with a readable unit
+string formatTime(double ns) {
+    ostringstream out;
+    out << fixed << setprecision(ns < 10 ? 3 : ns < 1000 ? 1 : 2);
+    if (ns < 1000)
+        out << ns << " ns";
+    else if (ns < 1e6)
+        out << ns / 1e3 << " us";
+    else
+        out << ns / 1e6 << " ms";
+    return out.str();
+}
+
+int main(int argc, char* argv[]) {
+    string filter, jsonPath, baselinePath;
+    int reps = 21;
+    double minTimeMs = 20;
+    double warmupMs = 100;
+    double threshold = 5;
+    uint64_t seed = 0x4B42454E4348ull;
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--filter") == 0 && i + 1 < argc)
+            filter = argv[++i];
+        else if (strcmp(argv[i], "--reps") == 0 && i + 1 < argc)
+            reps = max(3, atoi(argv[++i]));
+        else if (strcmp(argv[i], "--min-time") == 0 && i + 1 < argc)
+            minTimeMs = atof(argv[++i]);
+        else if (strcmp(argv[i], "--warmup") == 0 && i + 1 < argc)
+            warmupMs = atof(argv[++i]);
+        else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc)
+            seed = strtoull(argv[++i], nullptr, 10);
+        else if (strcmp(argv[i], "--json") == 0 && i + 1 < argc)
+            jsonPath = argv[++i];
+        else if (strcmp(argv[i], "--baseline") == 0 && i + 1 < argc)
+            baselinePath = argv[++i];
+        else if (strcmp(argv[i], "--threshold") == 0 && i + 1 < argc)
+            threshold = atof(argv[++i]);
+    }
+
+    map<string, BenchResult> baseline;
+    if (!baselinePath.empty() && !readBaseline(baselinePath, baseline)) {
+        cerr << "Error reading baseline " << baselinePath << endl;
+        return 1;
+    }
+
+    auto inputs = make_unique<BenchInputs>();
+    buildInputs(*inputs, seed);
+    vector<Benchmark> benches = makeBenchmarks(*inputs, seed);
+
+    cout << "CPU: " << cpuName() << ", " << reps << " samples of at least " << minTimeMs << " ms" << endl;
+    cout << left << setw(22) << "benchmark" << right << setw(13) << "median" << setw(26) << "95% interval"
+         << setw(16) << "ops/second";
+    if (!baseline.empty())
+        cout << setw(12) << "vs base";
+    cout << endl;
+
+    vector<BenchResult> results;
+    int slower = 0;
+    for (Benchmark& bench : benches) {
+        if (!filter.empty() && bench.name.find(filter) == string::npos)
+            continue;
+        BenchResult r = measure(bench, reps, minTimeMs, warmupMs);
+        results.push_back(r);
+
+        cout << left << setw(22) << r.name << right << setw(13) << formatTime(r.median) << setw(26)
+             << ("[" + formatTime(r.low) + ", " + formatTime(r.high) + "]") << setw(16)
+             << static_cast<long long>(1e9 / r.median);
+        auto base = baseline.find(r.name);
+        if (base != baseline.end() && base->second.median > 0) {
+            double change = (r.median / base->second.median - 1) * 100;
+            bool separate = r.low > base->second.high || r.high < base->second.low;
+            ostringstream verdict;
+            verdict << showpos << fixed << setprecision(1) << change << "%";
+            if (separate && change > threshold) {
+                verdict << " slower";
+                slower++;
+            } else if (separate && change < -threshold) {
+                verdict << " faster";
+            }
+            cout << setw(16) << verdict.str();
+        }
+        cout << "  per " << r.unit << endl;
+    }
+
+    if (!jsonPath.empty()) {
+        if (!writeJson(jsonPath, results, seed, reps, minTimeMs)) {
+            cerr << "Error writing " << jsonPath << endl;
+            return 1;
+        }
+        cout << "Results written to " << jsonPath << endl;
+    }
+    if (slower > 0) {
+        cout << slower << " benchmark(s) slower than the baseline" << endl;
+        return 3;
+    }
+    return 0;
+}
@@ -0,0 +1,417 @@
+/*****************************************************************************
+*
+*  Author:           Jesus Mendoza
+*  Email:            jesus.kyx.mendoza11@gmail.com
+*  Label:            Program 2C - Knucklebones Game
+*  Title:            Expectiminimax Computer Player
+*  Course:           CMPS 2143
+*  Semester:         Fall 2024
+*
+*  Description:
+*        A computer opponent that searches the game tree built from
+*        GameState. Decision nodes pick the column that is best for the
+*        player to move, chance nodes average over the six die faces.
+*
+*        Values are the score difference from the point of view of the
+*        player to move, so one search routine serves both players
+*        (negamax form). Chance nodes are pruned with Ballard's Star1 and
+*        Star2 rules, positions are cached in a Zobrist-hashed
+*        transposition table, and the search deepens one ply at a time
+*        until the per-move time budget runs out.
+*
+*        The hash only sees what matters for play: the dice in each column
+*        as a multiset, and the columns in any order (see canonical.hpp).
+*        Each column contributes a random key for its pair of multisets
+*        (one per grid) and the keys are added rather than XORed, so
+*        permuted columns hash alike and equivalent positions share one
+*        table entry. The side-to-move and rules keys are added too, so
+*        the whole hash is one sum and the search can update it in any
+*        order. Building with -DKNUCKLEBONES_CHECK_HASH makes every update
+*        assert that it equals zobristHash() of the new position.
+*
+*        The search walks one GameState in place with makeMove() and
+*        unmakeMove() instead of copying it at every node. Any rule variant
+*        works (see Rules in engine.hpp); cancellation only changes the
+*        opponent's half of the same column pair, so the incremental hash
+*        update stays one subtraction and one addition (plus the side key).
+*
+*  Usage:
+*        ExpectiminimaxAI ai(5.0);             // 5 ms per move
+*        int col = ai.chooseColumn(state, die);
+*        state.applyMove(col, die);
+*
+*****************************************************************************/
+
+#pragma once
+
+#include <cassert>
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+#include "canonical.hpp"
+#include "engine.hpp"
+
+// Random keys for every pair of column multisets (player 1's column,
+// player 2's column) plus the side to move, the die waiting to be placed
+// and the rule variant, so one table never mixes results of two variants
+struct ZobristKeys {
+    std::uint64_t column[COLUMN_MULTISETS][COLUMN_MULTISETS];
+    std::uint64_t side;
+    std::uint64_t die[7];
+    std::uint64_t rules[Rules::ALL_BITS + 1];
+};
+
+constexpr ZobristKeys makeZobristKeys() {
+    ZobristKeys keys{};
+    std::uint64_t seed = 0x4B6E75636B6C65ull;
+    for (auto& row : keys.column)
+        for (auto& key : row)
+            key = splitmix64(seed);
+    keys.side = splitmix64(seed);
+    for (auto& key : keys.die)
+        key = splitmix64(seed);
+    for (auto& key : keys.rules)
+        key = splitmix64(seed);
+    keys.rules[0] = 0;  // Standard rules hash as before
+    return keys;
+}
+
+inline constexpr ZobristKeys ZOBRIST = makeZobristKeys();
+
+// Key of one column pair of a position
+inline std::uint64_t columnKey(const GameState& state, int col) {
+    return ZOBRIST.column[columnMultiset(state.grids[0], col)][columnMultiset(state.grids[1], col)];
+}
+
+// Full hash of a position (the search updates it incrementally)
+inline std::uint64_t zobristHash(const GameState& state) {
+    std::uint64_t key = ZOBRIST.rules[state.rules.bits()] + (state.sideToMove() ? ZOBRIST.side : 0);
+    for (int col = 0; col < 3; ++col)
+        key += columnKey(state, col);
+    return key;
+}
+
+// Counters from the most recent call to chooseColumn()
+struct SearchStats {
+    long long nodes;     // Decision and chance nodes visited
+    long long ttHits;    // Searches answered from the transposition table
+    int depth;           // Deepest fully completed iteration, in plies
+    double value;        // Expected score difference for the mover
+    double milliseconds; // Time spent
+};
+
+/**
+ * Class Name: ExpectiminimaxAI
+ *
+ * Description:
+ *      Iterative-deepening expectiminimax search with Star1/Star2 chance
+ *      node pruning and a transposition table. The table is allocated once
+ *      and kept between moves.
+ *
+ * Public Methods:
+ *      - ExpectiminimaxAI(double budgetMs = 5.0, int maxDepth = 18, int tableBits = 20)
+ *      - int chooseColumn(const GameState& state, int die)
+ *      - const SearchStats& lastStats() const
+ *
+ * Private Members:
+ *      - std::vector<Entry> table
+ *      - double budgetMs
+ *      - int maxDepth
+ *      - SearchStats stats
+ *      - bool aborted
+ *
+ * Usage:
+ *      ExpectiminimaxAI ai(2.0);
+ *      int col = ai.chooseColumn(state, die);
+ */
+class ExpectiminimaxAI {
+    // Bounds on any value: a grid scores at most 3 * 54 points
+    static constexpr double MIN_VALUE = -162.0;
+    static constexpr double MAX_VALUE = 162.0;
+
+    enum Bound : std::uint8_t { EXACT, LOWER, UPPER };
+
+    struct Entry {
+        std::uint64_t key;
+        float value;
+        std::int8_t depth;   // -1 marks an empty slot
+        Bound bound;
+        std::int16_t move;   // Best column at a decision node, stored as
+                             // its multiset pair so it survives column swaps
+    };
+
+    std::vector<Entry> table;
+    std::uint64_t tableMask;
+    double budgetMs;
+    int maxDepth;
+    SearchStats stats;
+    bool aborted;
+    std::chrono::steady_clock::time_point deadline;
+
+    // Score difference from the point of view of the player to move
+    static double evaluate(const GameState& state) {
+        GameScores s = state.scores();
+        double diff = s.player1 - s.player2;
+        return state.sideToMove() == 0 ? diff : -diff;
+    }
+
+    Entry* probe(std::uint64_t key) {
+        Entry* entry = &table[key & tableMask];
+        return entry->key == key && entry->depth >= 0 ? entry : nullptr;
+    }
+
+    // Identifies a column by its contents rather than its position
+    static int columnPair(const GameState& state, int col) {
+        return columnMultiset(state.grids[0], col) * COLUMN_MULTISETS + columnMultiset(state.grids[1], col);
+    }
+
+    void store(std::uint64_t key, double value, int depth, double alpha, double beta, int move) {
+        Entry& entry = table[key & tableMask];
+        if (entry.key != key && entry.depth > depth)
+            return;  // Keep the deeper result of another position
+        entry.key = key;
+        entry.value = static_cast<float>(value);
+        entry.depth = static_cast<std::int8_t>(depth);
+        entry.bound = value <= alpha ? UPPER : value >= beta ? LOWER : EXACT;
+        entry.move = static_cast<std::int16_t>(move);
+    }
+
+    // Returns true if a stored result settles this node for the window
+    static bool cutoff(const Entry* entry, int depth, double alpha, double beta, double& value) {
+        if (!entry || entry->depth < depth)
+            return false;
+        value = entry->value;
+        return entry->bound == EXACT ||
+               (entry->bound == LOWER && value >= beta) ||
+               (entry->bound == UPPER && value <= alpha);
+    }
+
+    bool outOfTime() {
+        if ((++stats.nodes & 1023) == 0 && budgetMs > 0 && std::chrono::steady_clock::now() >= deadline)
+            aborted = true;
+        return aborted;
+    }
+
+    // Fills moves[] with the legal columns, best known move first
+    static int orderMoves(const GameState& state, const Entry* entry, int moves[3]) {
+        int count = 0;
+        for (int col = 0; col < 3; ++col) {
+            if (!state.isLegal(col))
+                continue;
+            moves[count++] = col;
+            if (entry && count > 1 && columnPair(state, col) == entry->move) {
+                moves[count - 1] = moves[0];
+                moves[0] = col;
+            }
+        }
+        return count;
+    }
+
+    // Value of placing the die in one column, from the mover's view. The
+    // move is made on state and taken back before returning.
+    double searchMove(GameState& state, std::uint64_t key, int col, int die, int depth,
+                      double alpha, double beta) {
+        std::uint64_t oldColumn = columnKey(state, col);
+        MoveUndo undo;
+        state.makeMove(col, die, undo);
+        // Addition like zobristHash(); an XOR here would not commute with
+        // the column sums, and transpositions would get different keys
+        std::uint64_t childKey = key - oldColumn + columnKey(state, col) +
+                                 (state.sideToMove() ? ZOBRIST.side : std::uint64_t(0) - ZOBRIST.side);
+#ifdef KNUCKLEBONES_CHECK_HASH
+        assert(childKey == zobristHash(state));
+#endif
+        double value = -chance(state, childKey, depth - 1, -beta, -alpha);
+        state.unmakeMove(undo);
+        return value;
+    }
+
+    // Decision node: the player to move has rolled `die` and picks a column
+    double decision(GameState& state, std::uint64_t key, int die, int depth,
+                    double alpha, double beta, int* bestMove = nullptr) {
+        if (outOfTime())
+            return 0;
+
+        std::uint64_t nodeKey = key ^ ZOBRIST.die[die];
+        Entry* entry = probe(nodeKey);
+        double value;
+        if (!bestMove && cutoff(entry, depth, alpha, beta, value)) {
+            stats.ttHits++;
+            return value;
+        }
+
+        int moves[3];
+        int count = orderMoves(state, entry, moves);
+        // Only reached from positions that are not over, so there is a move
+        assert(count > 0);
+        double best = MIN_VALUE - 1;
+        int move = moves[0];
+        double a = alpha;
+        for (int i = 0; i < count; ++i) {
+            double v = searchMove(state, key, moves[i], die, depth, a, beta);
+            if (aborted)
+                return 0;
+            if (v > best) {
+                best = v;
+                move = moves[i];
+            }
+            if (best > a)
+                a = best;
+            if (best >= beta)
+                break;
+        }
+
+        store(nodeKey, best, depth, alpha, beta, columnPair(state, move));
+        if (bestMove)
+            *bestMove = move;
+        return best;
+    }
+
+    // Chance node: the player to move is about to roll. Star2 first probes
+    // one move per die to get lower bounds, then Star1 searches each die
+    // with a window narrowed by what the other dice can still add.
+    double chance(GameState& state, std::uint64_t key, int depth, double alpha, double beta) {
+        if (state.isTerminal() || depth <= 0)
+            return evaluate(state);
+        if (outOfTime())
+            return 0;
+
+        Entry* entry = probe(key);
+        double value;
+        if (cutoff(entry, depth, alpha, beta, value)) {
+            stats.ttHits++;
+            return value;
+        }
+
+        // Star2 probing phase
+        double lower[7];
+        double lowerSum = 6 * MIN_VALUE;
+        for (int die = 1; die <= 6; ++die) {
+            const Entry* child = probe(key ^ ZOBRIST.die[die]);
+            int moves[3];
+            orderMoves(state, child, moves);
+
+            double childBeta = 6 * beta - (lowerSum - MIN_VALUE);
+            double v = searchMove(state, key, moves[0], die, depth, MIN_VALUE,
+                                  childBeta < MAX_VALUE ? childBeta : MAX_VALUE);
+            if (aborted)
+                return 0;
+            lower[die] = v;
+            lowerSum += v - MIN_VALUE;
+            if (lowerSum >= 6 * beta) {
+                store(key, lowerSum / 6, depth, alpha, beta, 0);
+                return lowerSum / 6;
+            }
+        }
+
+        // Star1 search phase
+        double sum = 0;
+        double restLower = lowerSum;
+        for (int die = 1; die <= 6; ++die) {
+            restLower -= lower[die];
+            double restUpper = (6 - die) * MAX_VALUE;
+            double childAlpha = 6 * alpha - sum - restUpper;
+            double childBeta = 6 * beta - sum - restLower;
+
+            double v = decision(state, key, die, depth,
+                                childAlpha > MIN_VALUE ? childAlpha : MIN_VALUE,
+                                childBeta < MAX_VALUE ? childBeta : MAX_VALUE);
+            if (aborted)
+                return 0;
+            sum += v;
+            if (v <= childAlpha) {
+                value = (sum + restUpper) / 6;
+                store(key, value, depth, alpha, beta, 0);
+                return value;
+            }
+            if (v >= childBeta) {
+                value = (sum + restLower) / 6;
+                store(key, value, depth, alpha, beta, 0);
+                return value;
+            }
+        }
+
+        value = sum / 6;
+        store(key, value, depth, alpha, beta, 0);
+        return value;
+    }
+
+public:
+    /**
+     * Public : ExpectiminimaxAI
+     *
+     * Description:
+     *      Sets the per-move time budget and allocates the transposition table.
+     *
+     * Params:
+     *      - double budgetMs : Time allowed per move in milliseconds (0 searches
+     *                          to maxDepth with no time limit, for reproducible runs).
+     *      - int maxDepth : Deepest iteration to try, in plies.
+     *      - int tableBits : The table holds 2^tableBits entries.
+     *
+     * Returns:
+     *      - None
+     */
+    explicit ExpectiminimaxAI(double budgetMs = 5.0, int maxDepth = 18, int tableBits = 20)
+        : table(std::size_t(1) << tableBits, Entry{0, 0.0f, -1, EXACT, 0}),
+          tableMask((std::uint64_t(1) << tableBits) - 1),
+          budgetMs(budgetMs), maxDepth(maxDepth), stats{}, aborted(false) {}
+
+    /**
+     * Public : chooseColumn
+     *
+     * Description:
+     *      Searches one ply deeper at a time until the time budget is spent
+     *      or the end of the game is reached, and returns the best column
+     *      found by the deepest completed iteration.
+     *
+     * Params:
+     *      - const GameState& state : Position with the player to move.
+     *      - int die : The value the player rolled (1-6).
+     *
+     * Returns:
+     *      - int : The column to play (0-2), or -1 if the game is over.
+     */
+    int chooseColumn(const GameState& state, int die) {
+        auto start = std::chrono::steady_clock::now();
+        deadline = start + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                               std::chrono::duration<double, std::milli>(budgetMs));
+        stats = SearchStats{};
+        aborted = false;
+        if (state.isTerminal())
+            return -1;
+
+        GameState position = state;  // Searched in place
+        std::uint64_t key = zobristHash(position);
+        int best = -1;
+        // Without cancellation a grid only fills up, so the game has at
+        // most 18 moves; with it the length is open-ended
+        int limit = maxDepth;
+        if (!state.rules.cancellation && 18 - state.turn < limit)
+            limit = 18 - state.turn;
+        for (int depth = 1; depth <= limit; ++depth) {
+            int move;
+            double value = decision(position, key, die, depth, MIN_VALUE, MAX_VALUE, &move);
+            if (aborted)
+                break;
+            best = move;
+            stats.depth = depth;
+            stats.value = value;
+        }
+
+        // Always answer, even if not one iteration finished in time
+        if (best < 0) {
+            for (int col = 0; col < 3 && best < 0; ++col)
+                if (state.isLegal(col))
+                    best = col;
+        }
+
+        stats.milliseconds =
+            std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        return best;
+    }
+
+    // Counters from the last search
+    const SearchStats& lastStats() const { return stats; }
+};
@@ -0,0 +1,283 @@
+/*****************************************************************************
+*
+*  Author:           Jesus Mendoza
+*  Email:            jesus.kyx.mendoza11@gmail.com
+*  Label:            Program 2C - Knucklebones Game
+*  Title:            Frame Time and Draw Call Profiler
+*  Course:           CMPS 2143
+*  Semester:         Fall 2024
+*
+*  Description:
+*        Measures where each frame of the game loop spends its CPU time.
+*        The loop calls mark() after each part of the frame and the time
+*        since the previous mark is charged to that part: event handling,
+*        turn/animation updates, grid drawing, other drawing, the overlay
+*        itself and display(). display() also waits out the frame cap or
+*        vsync, so the overlay reports the busy time (everything but
+*        display()) separately from the full frame. Every draw call is
+*        counted, and so is every change of bound texture (SFML rebinds
+*        only when the texture differs from the last one drawn with).
+*
+*        The overlay shows the last 600 frames (10 s at 60 fps): per part
+*        means, p50/p95/p99 of the busy and full frame times and a
+*        histogram of the busy time. When profiling was on at any point,
+*        every recorded frame can be written to a CSV file at exit.
+*
+*        Every recorded frame is kept in memory for the CSV, 32 bytes each,
+*        so a profiling session grows by about 7 MB per hour at 60 fps.
+*        Turn profiling off when it is not needed.
+*
+*  Usage:
+*        FrameProfiler profiler;
+*        profiler.beginFrame();
+*        // ... handle events ...
+*        profiler.mark(FrameProfiler::EVENTS);
+*        window.draw(sprite);
+*        profiler.countDraw(&texture);
+*        profiler.endFrame();
+*        profiler.writeCsv("frames.csv");
+*
+*****************************************************************************/
+
+#pragma once
+
+#include <SFML/Graphics.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+
+/**
+ * Class Name: FrameProfiler
+ *
+ * Description:
+ *      Per-frame CPU timings and draw statistics, with an on-screen overlay
+ *      and CSV export. Frames are only recorded while it is enabled.
+ *
+ * Public Methods:
+ *      - FrameProfiler()
+ *      - void setEnabled(bool enabled)
+ *      - bool isEnabled() const
+ *      - bool wasUsed() const
+ *      - void beginFrame()
+ *      - void mark(Section section)
+ *      - void countDraw(const sf::Texture* texture)
+ *      - void endFrame()
+ *      - void drawOverlay(sf::RenderWindow& window, const sf::Font& font)
+ *      - bool writeCsv(const std::string& path) const
+ *
+ * Private Members:
+ *      - std::vector<Frame> frames
+ *      - Frame current
+ *      - Clock::time_point lastMark
+ *      - const sf::Texture* bound
+ *      - bool enabled, used
+ *      - int framesSinceText
+ *      - sf::Text text
+ *      - sf::VertexArray bars
+ */
+class FrameProfiler {
+public:
+    // Parts of a frame, in the order the game loop runs them
+    enum Section { EVENTS, UPDATE, GRIDS, DRAW, OVERLAY, DISPLAY, SECTIONS };
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Frame {
+        float micros[SECTIONS];  // CPU time per section in microseconds
+        int drawCalls;
+        int textureBinds;
+    };
+
+    static constexpr std::size_t WINDOW = 600;        // Frames shown on the overlay
+    static constexpr int BUCKETS = 50;                // Histogram bars
+    static constexpr float BUCKET_MICROS = 500;       // 0.5 ms per bar
+    static constexpr int TEXT_EVERY = 15;             // Frames between overlay text updates
+
+    std::vector<Frame> frames;    // Every recorded frame, for the CSV (never trimmed)
+    Frame current;
+    Clock::time_point lastMark;
+    const sf::Texture* bound;     // Texture of the previous draw call
+    bool enabled;
+    bool used;                    // Enabled at some point
+    int framesSinceText;
+    sf::Text text;
+    sf::VertexArray bars;
+
+    static float total(const Frame& frame) {
+        float sum = 0;
+        for (int s = 0; s < SECTIONS; ++s)
+            sum += frame.micros[s];
+        return sum;
+    }
+
+    static const char* sectionName(int section) {
+        static const char* names[SECTIONS] = {"events", "update", "grids", "draw", "overlay", "display"};
+        return names[section];
+    }
+
+    // Rebuilds the text and histogram from the last WINDOW frames
+    void refresh(const sf::Font& font) {
+        std::size_t count = std::min(frames.size(), WINDOW);
+        if (count == 0)
+            return;
+        auto first = frames.end() - count;
+
+        std::vector<float> totals, busy;
+        float means[SECTIONS] = {0};
+        double drawCalls = 0, binds = 0;
+        int histogram[BUCKETS] = {0};
+        for (auto it = first; it != frames.end(); ++it) {
+            float t = total(*it);
+            float work = t - it->micros[DISPLAY];
+            totals.push_back(t);
+            busy.push_back(work);
+            for (int s = 0; s < SECTIONS; ++s)
+                means[s] += it->micros[s] / count;
+            drawCalls += it->drawCalls;
+            binds += it->textureBinds;
+            histogram[std::min(BUCKETS - 1, static_cast<int>(work / BUCKET_MICROS))]++;
+        }
+        std::sort(totals.begin(), totals.end());
+        std::sort(busy.begin(), busy.end());
+        auto at = [&](const std::vector<float>& sorted, double fraction) {
+            return sorted[static_cast<std::size_t>(fraction * (count - 1))] / 1000;
+        };
+
+        char line[128];
+        std::string report;
+        std::snprintf(line, sizeof(line), "busy ms   p50 %.2f  p95 %.2f  p99 %.2f  max %.2f\n",
+                      at(busy, 0.5), at(busy, 0.95), at(busy, 0.99), busy.back() / 1000);
+        report += line;
+        std::snprintf(line, sizeof(line), "frame ms  p50 %.2f  p95 %.2f  p99 %.2f  max %.2f\n",
+                      at(totals, 0.5), at(totals, 0.95), at(totals, 0.99), totals.back() / 1000);
+        report += line;
+        for (int s = 0; s < SECTIONS; ++s) {
+            std::snprintf(line, sizeof(line), "  %-8s %.3f ms\n", sectionName(s), means[s] / 1000);
+            report += line;
+        }
+        std::snprintf(line, sizeof(line), "draws %.1f  texture binds %.1f  (%zu frames)",
+                      drawCalls / count, binds / count, count);
+        report += line;
+
+        text.setFont(font);
+        text.setCharacterSize(14);
+        text.setFillColor(sf::Color::Green);
+        text.setPosition(560, 10);
+        text.setString(report);
+
+        // Histogram of busy time, 0.5 ms per bar, under the text
+        int tallest = *std::max_element(histogram, histogram + BUCKETS);
+        bars.clear();
+        for (int b = 0; b < BUCKETS; ++b) {
+            float height = 60.0f * histogram[b] / tallest;
+            float x = 560 + b * 4.5f, bottom = 280;
+            sf::Color color = b * BUCKET_MICROS < 16667 ? sf::Color::Green : sf::Color::Red;  // Over a 60 fps frame
+            bars.append(sf::Vertex(sf::Vector2f(x, bottom - height), color));
+            bars.append(sf::Vertex(sf::Vector2f(x + 3.5f, bottom - height), color));
+            bars.append(sf::Vertex(sf::Vector2f(x + 3.5f, bottom), color));
+            bars.append(sf::Vertex(sf::Vector2f(x, bottom), color));
+        }
+    }
+
+public:
+    FrameProfiler()
+        : current{}, lastMark(Clock::now()), bound(nullptr), enabled(false), used(false),
+          framesSinceText(TEXT_EVERY), bars(sf::Quads) {}
+
+    void setEnabled(bool on) {
+        enabled = on;
+        used = used || on;
+    }
+
+    bool isEnabled() const { return enabled; }
+
+    // True if profiling was ever turned on, even if no frame was recorded
+    // while it was
+    bool wasUsed() const { return used; }
+
+    void beginFrame() {
+        current = Frame{};
+        bound = nullptr;
+        lastMark = Clock::now();
+    }
+
+    // Charges the time since the previous mark to a section
+    void mark(Section section) {
+        Clock::time_point now = Clock::now();
+        current.micros[section] += std::chrono::duration<float, std::micro>(now - lastMark).count();
+        lastMark = now;
+    }
+
+    // Records one draw call made with the given texture (null if untextured)
+    void countDraw(const sf::Texture* texture) {
+        current.drawCalls++;
+        if (texture != bound)
+            current.textureBinds++;
+        bound = texture;
+    }
+
+    void endFrame() {
+        if (enabled)
+            frames.push_back(current);
+    }
+
+        /**
+     * Public : drawOverlay
+     *
+     * Description:
+     *      Draws the statistics in the top-right corner. The text is rebuilt
+     *      every 15 frames so the overlay stays cheap and readable.
+     *
+     * Params:
+     *      - sf::RenderWindow& window : The window to draw on.
+     *      - const sf::Font& font : Font for the statistics.
+     *
+     * Returns:
+     *      - None
+     */
+    void drawOverlay(sf::RenderWindow& window, const sf::Font& font) {
+        if (!enabled)
+            return;
+        if (++framesSinceText >= TEXT_EVERY) {
+            refresh(font);
+            framesSinceText = 0;
+        }
+        window.draw(bars);
+        window.draw(text);
+    }
+
+        /**
+     * Public : writeCsv
+     *
+     * Description:
+     *      Writes one row per recorded frame: the time of each section in
+     *      microseconds, the total, and the draw call and texture bind counts.
+     *
+     * Params:
+     *      - const std::string& path : File to write.
+     *
+     * Returns:
+     *      - bool : false if the file cannot be written.
+     */
+    bool writeCsv(const std::string& path) const {
+        std::ofstream out(path);
+        if (!out)
+            return false;
+        out << "frame";
+        for (int s = 0; s < SECTIONS; ++s)
+            out << ',' << sectionName(s) << "_us";
+        out << ",total_us,draw_calls,texture_binds\n";
+        for (std::size_t i = 0; i < frames.size(); ++i) {
+            out << i;
+            for (int s = 0; s < SECTIONS; ++s)
+                out << ',' << frames[i].micros[s];
+            out << ',' << total(frames[i]) << ',' << frames[i].drawCalls << ',' << frames[i].textureBinds << '\n';
+        }
+        return static_cast<bool>(out);
+    }
+};
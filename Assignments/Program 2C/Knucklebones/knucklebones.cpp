@@ -14,10 +14,14 @@
 *        animations for rolling dice, visual representation of dice faces, and 
 *        dynamic score calculation based on grid placement rules.
 *
-*        The game alternates between two players for a total of 18 turns (9 
-*        per player), and the player with the highest score at the end wins. 
+*        Under the standard rules the game alternates between two players
+*        for a total of 18 turns (9 per player), and the player with the
+*        highest score at the end wins.
 *        The program utilizes the SFML library for graphics rendering and 
-*        animations.
+*        animations. Every image and the font are loaded once at start-up,
+*        from disk or, when built with embedded assets, from the binary
+*        itself (see assets.hpp); the dice faces and animation frames share
+*        one texture.
 *
 *  Usage:
 *        - Run the program to start the game.
@@ -25,14 +29,31 @@
 *        - Use the left mouse button to click a column in your grid to place 
 *          the dice.
 *        - Play alternates between two players until all grid spaces are filled.
+*        - Run with --classic for the original rules: placing a die knocks
+*          out the opponent's dice of the same value in that column, and the
+*          game ends as soon as either grid is full.
+*        - Run with --ai to make Player 2 a computer opponent, or with
+*          --solved <table> for a perfect one (see solve.cpp).
+*        - Run with --record <file> to save the game, and with
+*          --replay <file> [game] to watch a recorded game (see record.hpp).
+*        - Add --vsync to pace frames with the display instead of the
+*          60 frames per second cap.
+*        - Press F3 (or set KNUCKLEBONES_PROFILE=1, or to a CSV path) to
+*          show frame timings; they are saved as CSV on exit.
 *
 *  Files:            
-*        main.cpp                           : Contains the main logic and game loop.
+*        knucklebones.cpp                   : SFML front end and game loop.
+*        assets.hpp                         : Texture atlas and font loading.
+*        engine.hpp                         : Headless rules (Grid, Dice, GameState).
+*        expectiminimax.hpp                 : Computer opponent.
+*        frame_profiler.hpp                 : Frame timing overlay.
+*        record.hpp                         : Game record format.
+*        solver.hpp                         : Perfect-play table reader.
 *        images/                            : Directory containing all image assets.
 *          - frame_001.png to frame_024.png : Dice animation frames.
 *          - 1.png to 6.png                 : Dice face images.
 *          - knuckleboneslogo.jpg           : Game logo.
-*         arial.ttf                         : Font file for rendering text.
+*         Arial.ttf                         : Font file for rendering text.
 *
 *****************************************************************************/
 
@@ -45,6 +66,14 @@
 #include <iomanip>
 #include <ctime>
 #include <iostream>
+#include <sstream>
+
+#include "assets.hpp"
+#include "engine.hpp"
+#include "expectiminimax.hpp"
+#include "frame_profiler.hpp"
+#include "record.hpp"
+#include "solver.hpp"
 
 // Standard namespaces for convenience
 using namespace std;
@@ -54,29 +83,30 @@ using namespace std;
  *
  * Description:
  *      Handles the animation of dice rolling by iterating through preloaded frames.
+ *      The frames are rectangles of the shared atlas, so creating an
+ *      animation costs nothing.
  *
  * Public Methods:
- *      - DiceAnimation(float duration)
+ *      - DiceAnimation(const AssetManager& assets, float duration)
+ *      - void reset()
  *      - void update(float deltaTime)
  *      - void draw(sf::RenderWindow& window, sf::Vector2f position)
  *
  * Private Members:
+ *      - const AssetManager& assets
  *      - sf::Sprite sprite
- *      - sf::Texture texture
- *      - std::vector<sf::Texture> frames
  *      - int currentFrame
  *      - float frameDuration
  *      - float currentTime
  *
  * Usage:
- *      DiceAnimation diceAnimation(1.0f); // Create animation object
+ *      DiceAnimation diceAnimation(assets, 1.0f); // Create animation object
  *      diceAnimation.update(deltaTime);  // Update animation based on elapsed time
  *      diceAnimation.draw(window, position); // Render the current frame
  */
 class DiceAnimation {
+    const AssetManager& assets;       // Atlas holding the frames
     sf::Sprite sprite;                // Sprite to display the current frame
-    sf::Texture texture;              // Texture for the sprite
-    std::vector<sf::Texture> frames;  // Vector storing animation frames
     int currentFrame;                 // Current frame index
     float frameDuration;              // Duration of each frame in seconds
     float currentTime;                // Tracks elapsed time for frame switching
@@ -86,27 +116,26 @@ public:
      * Public : DiceAnimation
      *
      * Description:
-     *      Initializes the dice animation by loading a series of frames and setting the frame duration.
+     *      Initializes the dice animation on the first frame and sets the frame duration.
      *
      * Params:
+     *      - const AssetManager& assets : Loaded assets holding the frames.
      *      - float duration : Total duration of the animation in seconds.
      *
      * Returns:
      *      - None
      */
-    DiceAnimation(float duration)
-        : currentFrame(0), frameDuration(duration / 24), currentTime(0) {
-        for (int i = 1; i <= 24; ++i) {
-            sf::Texture frame;
-            std::ostringstream filename;
-            filename << "images/frame_" << std::setw(3) << std::setfill('0') << i << ".png";
-            if (!frame.loadFromFile(filename.str())) {
-                cerr << "Error loading animation frame " << filename.str() << endl;
-                exit(EXIT_FAILURE);
-            }
-            frames.push_back(frame);
-        }
-        sprite.setTexture(frames[0]);
+    DiceAnimation(const AssetManager& assets, float duration)
+        : assets(assets), currentFrame(0), frameDuration(duration / 24), currentTime(0) {
+        sprite.setTexture(assets.getAtlas());
+        sprite.setTextureRect(assets.frameRect(0));
+    }
+
+    // Starts the animation over from the first frame
+    void reset() {
+        currentFrame = 0;
+        currentTime = 0;
+        sprite.setTextureRect(assets.frameRect(0));
     }
 
         /**
@@ -126,7 +155,7 @@ public:
         if (currentTime >= frameDuration) {
             currentTime -= frameDuration;
             currentFrame = (currentFrame + 1) % 24;  // Loop back to first frame
-            sprite.setTexture(frames[currentFrame]);
+            sprite.setTextureRect(assets.frameRect(currentFrame));
         }
     }
 
@@ -153,31 +182,34 @@ public:
  * Class Name: DiceFace
  *
  * Description:
- *      Manages the display of a single dice face using textures.
+ *      Manages the display of a single dice face using the shared atlas.
  *
  * Public Methods:
+ *      - DiceFace(const AssetManager& assets)
  *      - void setFace(int value)
  *      - void draw(sf::RenderWindow& window, sf::Vector2f position)
  *
  * Private Members:
+ *      - const AssetManager& assets
  *      - sf::Sprite sprite
- *      - sf::Texture texture
  *
  * Usage:
- *      DiceFace diceFace;
+ *      DiceFace diceFace(assets);
  *      diceFace.setFace(6); // Set dice face to show the value 6
  *      diceFace.draw(window, position); // Draw the dice face
  */
 class DiceFace {
+    const AssetManager& assets;
     sf::Sprite sprite;
-    sf::Texture texture;
 
 public:
+    DiceFace(const AssetManager& assets) : assets(assets) { sprite.setTexture(assets.getAtlas()); }
+
         /**
      * Public : setFace
      *
      * Description:
-     *      Sets the texture of the dice face based on the given value.
+     *      Points the sprite at the atlas rectangle for the given value.
      *
      * Params:
      *      - int value : The dice face value (1-6).
@@ -185,13 +217,7 @@ public:
      * Returns:
      *      - None
      */
-    void setFace(int value) {
-        if (!texture.loadFromFile("images/" + to_string(value) + ".png")) {
-            cerr << "Error loading dice face: " << value << endl;
-            exit(EXIT_FAILURE);
-        }
-        sprite.setTexture(texture);
-    }
+    void setFace(int value) { sprite.setTextureRect(assets.faceRect(value)); }
 
         /**
      * Public : draw
@@ -213,149 +239,130 @@ public:
 };
 
 /**
- * Class Name: Dice
+ * Class Name: GridRenderer
  *
  * Description:
- *      Simulates a dice roll to generate random values.
+ *      Draws one grid and its dice values in two draw calls. The cell
+ *      outlines and fills go into one untextured vertex array and the digits
+ *      into a second one that samples the font's glyph texture directly, so
+ *      no sf::Text or sf::RectangleShape is built per cell. Both arrays are
+ *      rebuilt only when the packed grid differs from the one last drawn.
  *
  * Public Methods:
- *      - Dice()
- *      - int roll()
+ *      - GridRenderer()
+ *      - void setup(const sf::Font& font, sf::Vector2f position, sf::Color color)
+ *      - void draw(sf::RenderWindow& window, const Grid& grid, FrameProfiler* profiler = nullptr)
+ *
+ * Private Members:
+ *      - const sf::Font* font
+ *      - sf::Vector2f position
+ *      - sf::Color color
+ *      - sf::VertexArray cells
+ *      - sf::VertexArray digits
+ *      - std::uint32_t shown
  *
  * Usage:
- *      Dice dice;
- *      int result = dice.roll(); // Roll the dice and get a value between 1 and 6
+ *      GridRenderer board;
+ *      board.setup(font, sf::Vector2f(150, 200), sf::Color::Red);
+ *      board.draw(window, grid);   // Rebuilds only after a move
  */
-class Dice {
+class GridRenderer {
+    static const unsigned CHARACTER_SIZE = 24;
+    static const std::uint32_t NOTHING_SHOWN = 0xFFFFFFFF;  // Never a packed grid
+
+    const sf::Font* font;
+    sf::Vector2f position;
+    sf::Color color;
+    sf::VertexArray cells;   // Outline and fill quads of the 9 cells
+    sf::VertexArray digits;  // One textured quad per die
+    std::uint32_t shown;     // Packed grid the arrays were built for
+
+    static void addQuad(sf::VertexArray& array, sf::FloatRect rect, sf::Color color, sf::FloatRect texture = sf::FloatRect()) {
+        float right = rect.left + rect.width, bottom = rect.top + rect.height;
+        float texRight = texture.left + texture.width, texBottom = texture.top + texture.height;
+        array.append(sf::Vertex(sf::Vector2f(rect.left, rect.top), color, sf::Vector2f(texture.left, texture.top)));
+        array.append(sf::Vertex(sf::Vector2f(right, rect.top), color, sf::Vector2f(texRight, texture.top)));
+        array.append(sf::Vertex(sf::Vector2f(right, bottom), color, sf::Vector2f(texRight, texBottom)));
+        array.append(sf::Vertex(sf::Vector2f(rect.left, bottom), color, sf::Vector2f(texture.left, texBottom)));
+    }
+
+    // Lays out the cells and digits the way sf::RectangleShape and sf::Text would
+    void rebuild(const Grid& grid) {
+        cells.clear();
+        digits.clear();
+        for (int i = 0; i < 3; ++i) {
+            for (int j = 0; j < 3; ++j) {
+                float x = position.x + j * 70, y = position.y + i * 70;
+                addQuad(cells, sf::FloatRect(x - 2, y - 2, 64, 64), color);  // 2px outline
+                addQuad(cells, sf::FloatRect(x, y, 60, 60), sf::Color::White);
+
+                int value = grid.at(i, j);
+                if (value != 0) {
+                    const sf::Glyph& glyph = font->getGlyph('0' + value, CHARACTER_SIZE, false);
+                    sf::FloatRect quad(x + 20 + glyph.bounds.left, y + 10 + CHARACTER_SIZE + glyph.bounds.top,
+                                       glyph.bounds.width, glyph.bounds.height);
+                    sf::FloatRect texture(glyph.textureRect.left, glyph.textureRect.top,
+                                          glyph.textureRect.width, glyph.textureRect.height);
+                    addQuad(digits, quad, sf::Color::Black, texture);
+                }
+            }
+        }
+        shown = grid.packed();
+    }
+
 public:
+    GridRenderer() : font(nullptr), color(sf::Color::White), cells(sf::Quads), digits(sf::Quads), shown(NOTHING_SHOWN) {}
+
         /**
-     * Public : Dice
+     * Public : setup
      *
      * Description:
-     *      Initializes the random number generator for dice rolls.
+     *      Sets where and in which color the grid is drawn, and renders the
+     *      six digits into the font's glyph texture up front so their
+     *      texture coordinates stay put for the rest of the game.
      *
      * Params:
-     *      - None
+     *      - const sf::Font& font : Font for the dice values.
+     *      - sf::Vector2f position : Top-left corner of the grid.
+     *      - sf::Color color : Outline color of the cells.
      *
      * Returns:
      *      - None
      */
-    Dice() { srand(static_cast<unsigned>(time(0))); }  
+    void setup(const sf::Font& font, sf::Vector2f position, sf::Color color) {
+        this->font = &font;
+        this->position = position;
+        this->color = color;
+        for (int value = 1; value <= 6; ++value)
+            font.getGlyph('0' + value, CHARACTER_SIZE, false);
+        shown = NOTHING_SHOWN;
+    }
 
         /**
-     * Public : roll
+     * Public : draw
      *
      * Description:
-     *      Generates a random number between 1 and 6 to simulate a dice roll.
+     *      Draws the grid, rebuilding its geometry first if it has changed.
      *
      * Params:
-     *      - None
+     *      - sf::RenderWindow& window : The window where the grid is rendered.
+     *      - const Grid& grid : The grid to draw.
+     *      - FrameProfiler* profiler : Counts the draw calls, if given.
      *
      * Returns:
-     *      - int : The rolled dice value (1-6).
+     *      - None
      */
-    int roll() { return rand() % 6 + 1; }  // Returns a random value between 1 and 6
-};
-
-/**
- * Class Name: Grid
- *
- * Description:
- *      Represents a 3x3 grid for dice placement and score calculation.
- *
- * Public Methods:
- *      - Grid()
- *      - void clearGrid()
- *      - bool placeDice(int col, int value)
- *      - int calculateScore() const
- *      - void render(sf::RenderWindow& window, sf::Vector2f position, sf::Color color)
- *
- * Private Members:
- *      - int cells[3][3]
- *
- * Usage:
- *      Grid grid;
- *      grid.placeDice(1, 5); // Place a dice with value 5 in column 1
- *      int score = grid.calculateScore(); // Calculate the score of the grid
- *      grid.render(window, position, color); // Render the grid
- */
-class Grid {
-    int cells[3][3];  // 3x3 grid to store dice values
-
-public:
-    Grid() { clearGrid(); }  // Initialize the grid
-
-    // Resets all cells in the grid to zero
-    void clearGrid() {
-        for (auto& row : cells)
-            fill(row, row + 3, 0);
-    }
-
-    // Places a dice value in the specified column if space is available
-    bool placeDice(int col, int value) {
-        for (int row = 2; row >= 0; --row) {
-            if (cells[row][col] == 0) {
-                cells[row][col] = value;
-                return true;
-            }
-        }
-        return false;  // Column is full
-    }
-
-    // Calculates the total score based on grid values
-    int calculateScore() const {
-        int total = 0;
-        for (int col = 0; col < 3; ++col) {
-            int product = 0;
-            int counts[6] = {0};
-
-            // Count occurrences of each dice value in the column
-            for (int row = 0; row < 3; ++row) {
-                if (cells[row][col] != 0) {
-                    counts[cells[row][col] - 1]++;
-                }
-            }
-
-            // Calculate column score using dice values and counts
-            for (int i = 0; i < 6; ++i) {
-                if (counts[i] > 0) {
-                    product += counts[i] * (i + 1) * counts[i];
-                }
-            }
-
-            total += product;
-        }
-        return total;
-    }
-
-    // Renders the grid on the screen with its dice values
-    void render(sf::RenderWindow& window, sf::Vector2f position, sf::Color color) {
-        sf::RectangleShape cell(sf::Vector2f(60, 60));  // Individual cell size
-        cell.setOutlineColor(color);
-        cell.setOutlineThickness(2);
-
-        sf::Font font;
-        if (!font.loadFromFile("arial.ttf")) {
-            cerr << "Error loading font!" << endl;
-            return;
-        }
-
-        sf::Text text;
-        text.setFont(font);
-        text.setCharacterSize(24);
-        text.setFillColor(sf::Color::Black);
-
-        for (int i = 0; i < 3; ++i) {
-            for (int j = 0; j < 3; ++j) {
-                cell.setPosition(position.x + j * 70, position.y + i * 70);
-                window.draw(cell);
-
-                if (cells[i][j] != 0) {
-                    text.setString(to_string(cells[i][j]));
-                    text.setPosition(position.x + j * 70 + 20, position.y + i * 70 + 10);
-                    window.draw(text);
-                }
-            }
+    void draw(sf::RenderWindow& window, const Grid& grid, FrameProfiler* profiler = nullptr) {
+        if (grid.packed() != shown)
+            rebuild(grid);
+        window.draw(cells);
+        if (profiler)
+            profiler->countDraw(nullptr);
+        if (digits.getVertexCount() > 0) {
+            const sf::Texture* glyphs = &font->getTexture(CHARACTER_SIZE);
+            window.draw(digits, sf::RenderStates(glyphs));
+            if (profiler)
+                profiler->countDraw(glyphs);
         }
     }
 };
@@ -373,221 +380,479 @@ public:
     string getName() const { return name; }
 };
 
+// Where the game is within a turn
+enum class TurnPhase {
+    WaitingForRoll,  // Waiting for 'R' (the computer rolls at once)
+    Rolling,         // Dice animation playing
+    ShowingRoll,     // Rolled face on screen before the die can be placed
+    Placing,         // Waiting for a click on the player's grid
+    GameOver         // Final scores on screen
+};
+
 /**
  * Class Name: Game
  *
  * Description:
  *      Manages the game flow, including turns, dice rolls, and grid updates.
+ *      The rules themselves live in GameState; this class only handles input,
+ *      animation and drawing.
+ *
+ *      Everything runs from the one loop in play(): each frame handles the
+ *      pending events, advances the turn in fixed 1/60 s steps and draws.
+ *      A turn is a small state machine (see TurnPhase) whose phases end on
+ *      input or after a set time, so nothing ever blocks or sleeps, and the
+ *      frame rate cap keeps the loop from spinning a core.
  *
  * Public Methods:
- *      - Game()
+ *      - Game(bool computerPlayer2 = false, const string& solvedPath = "", bool vsync = false,
+ *             Rules rules = Rules())
+ *      - void recordTo(const string& path)
+ *      - bool replayFrom(const string& path, long long index)
  *      - void play()
- *      - void takeTurn(sf::RenderWindow& window, const sf::Vector2f& grid1Position, const sf::Vector2f& grid2Position, sf::Text& infoText)
- *      - void checkGameOver()
- *      - void endGame(sf::RenderWindow& window)
  *
  * Private Members:
  *      - Player player1, player2
- *      - Grid grid1, grid2
+ *      - AssetManager assets
+ *      - GridRenderer boards[2]
+ *      - DiceAnimation animation
+ *      - DiceFace face
+ *      - sf::Sprite logoSprite
+ *      - sf::Text infoText, resultText
+ *      - GameState state
  *      - Dice dice
- *      - int turn
+ *      - ExpectiminimaxAI ai
+ *      - SolvedTable solved
+ *      - FrameProfiler profiler
+ *      - string profilePath
+ *      - GameRecord record
+ *      - string recordPath
+ *      - bool replaying
+ *      - TurnPhase phase
+ *      - float phaseTime
+ *      - int roll
+ *      - bool computerPlayer2
+ *      - bool vsync
  *      - bool running
- *      - bool isValidClick(sf::Vector2i mousePos, const sf::Vector2f& gridPosition)
  *
  * Usage:
  *      Game game;
  *      game.play(); // Starts the game
  */
 class Game {
+    static constexpr unsigned FRAME_RATE = 60;         // Frame cap without vsync
+    static constexpr float STEP = 1.0f / 60;           // Fixed update step in seconds
+    static constexpr float MAX_LAG = 0.25f;            // Drop time beyond this after a stall
+    static constexpr float ROLL_TIME = 1.0f;           // Dice animation length
+    static constexpr float SHOW_TIME = 1.0f;           // Rolled face shown before placing
+    static constexpr float RESULT_TIME = 5.0f;         // Final scores shown before closing
+
+    const sf::Vector2f gridPositions[2] = {sf::Vector2f(150, 200), sf::Vector2f(450, 200)};
+    const sf::Vector2f dicePosition = sf::Vector2f(300, 300);
+
     Player player1, player2;        // Two players
-    Grid grid1, grid2;              // Grids for each player
+    AssetManager assets;            // Textures and font, loaded once
+    GridRenderer boards[2];         // Cached geometry of each player's grid
+    DiceAnimation animation;        // Rolling dice, restarted every turn
+    DiceFace face;                  // Rolled value
+    sf::Sprite logoSprite;
+    sf::Text infoText;              // Whose turn it is and what to do
+    sf::Text resultText;            // Final scores
+    GameState state;                // Both grids, the turn counter and the rules
     Dice dice;                      // Dice object for rolling
-    int turn;                       // Current turn number
+    ExpectiminimaxAI ai;            // Plays for Player 2 when enabled
+    SolvedTable solved;             // Perfect play for Player 2, if loaded
+    FrameProfiler profiler;         // Frame timings, shown with F3
+    string profilePath;             // CSV written at exit if profiling was used
+    GameRecord record;              // Moves of this game, or the game being replayed
+    string recordPath;              // Where to save the record, if anywhere
+    bool replaying;                 // Moves come from the record instead of players
+    TurnPhase phase;                // Current step of the turn
+    float phaseTime;                // Seconds spent in the current phase
+    int roll;                       // Value rolled this turn
+    bool computerPlayer2;           // Player 2 is controlled by the AI
+    bool vsync;                     // Pace frames with vsync instead of a frame cap
     bool running;                   // Game running status
 
+    // True when the side to move is played by the AI (or by the record)
+    bool isComputerTurn() const { return replaying || (computerPlayer2 && state.sideToMove() == 1); }
+
+    Player& currentPlayer() { return state.sideToMove() == 0 ? player1 : player2; }
+
     // Validates if a mouse click is within the grid boundaries
     bool isValidClick(sf::Vector2i mousePos, const sf::Vector2f& gridPosition) {
         sf::FloatRect gridBounds(gridPosition.x, gridPosition.y, 3 * 70, 3 * 70);  // 3x3 grid, 70px cell
         return gridBounds.contains(static_cast<sf::Vector2f>(mousePos));
     }
 
-public:
-    Game() : player1("Player 1"), player2("Player 2"), turn(0), running(true) {}
-
-    // Game loop handling events, rendering, and player turns
-    void play() {
-        sf::RenderWindow window(sf::VideoMode(800, 600), "Knucklebones Game");
+    // Switches phase and updates the text that goes with it
+    void enterPhase(TurnPhase next) {
+        phase = next;
+        phaseTime = 0;
+
+        int side = state.sideToMove();
+        infoText.setFillColor(side == 0 ? sf::Color::Red : sf::Color::Blue);
+        switch (phase) {
+        case TurnPhase::WaitingForRoll:
+            infoText.setString(currentPlayer().getName() + "'s Turn\nPress 'R' to roll.");
+            break;
+        case TurnPhase::Rolling:
+            infoText.setString(currentPlayer().getName() + "'s Turn");
+            break;
+        case TurnPhase::ShowingRoll:
+        case TurnPhase::Placing:
+            infoText.setString(currentPlayer().getName() + "'s Turn\nRolled: " + to_string(roll));
+            break;
+        case TurnPhase::GameOver:
+            showResult();
+            finishRecord();
+            break;
+        }
+    }
 
-        // Load logo
-        sf::Texture logoTexture;
-        if (!logoTexture.loadFromFile("images/knuckleboneslogo.jpg")) {
-            cerr << "Error loading logo!" << endl;
+    // Saves the finished game, or checks a replayed one against its record
+    void finishRecord() {
+        GameScores scores = state.scores();
+        if (replaying) {
+            if (state.turn != record.moves || scores.player1 != record.scores[0] || scores.player2 != record.scores[1])
+                cerr << "Replay differs from the record: scores " << scores.player1 << "-" << scores.player2
+                     << " after " << state.turn << " moves, recorded " << static_cast<int>(record.scores[0]) << "-"
+                     << static_cast<int>(record.scores[1]) << " after " << record.moves << endl;
+            else
+                cout << "Replay matches the record" << endl;
             return;
         }
-        sf::Sprite logoSprite;
-        logoSprite.setTexture(logoTexture);
-
-        // Resize logo to 200 pixels in width while maintaining aspect ratio
-        sf::Vector2u logoSize = logoTexture.getSize();
-        float logoScale = 200.0f / logoSize.x;
-        logoSprite.setScale(logoScale, logoScale);
-
-        // Center the logo at the top
-        float logoX = (window.getSize().x - logoSize.x * logoScale) / 2;
-        logoSprite.setPosition(logoX, 10);
-
-        // Load font
-        sf::Font font;
-        if (!font.loadFromFile("arial.ttf")) {
-            cerr << "Error loading font!" << endl;
+        if (recordPath.empty())
+            return;
+        if (state.turn > MAX_RECORD_MOVES) {
+            // addMove() stopped at the limit, so the record would not replay
+            cerr << "Warning: game not recorded, it ran " << state.turn << " moves (the limit is "
+                 << MAX_RECORD_MOVES << ")" << endl;
             return;
         }
+        record.finish(state);
+        RecordWriter writer;
+        if (writer.open(recordPath, state.rules)) {
+            writer.write(record);
+        }
+        if (!writer.close())
+            cerr << "Error writing game record " << recordPath << endl;
+    }
 
-        // Adjust positions of grids
-        sf::Vector2f grid1Position(150, 200); // Slightly lower to make space for the logo
-        sf::Vector2f grid2Position(450, 200);
+    void startRoll() {
+        roll = dice.roll();
+        face.setFace(roll);
+        animation.reset();
+        enterPhase(TurnPhase::Rolling);
+    }
 
-        // Text for instructions
-        sf::Text infoText;
-        infoText.setFont(font);
-        infoText.setCharacterSize(24); // Larger text for readability
-        infoText.setFillColor(sf::Color::White);
-        infoText.setPosition(20, 500); // Positioned below grids
+    // Places the rolled die, then starts the next turn or ends the game
+    bool placeDie(int col) {
+        if (!state.applyMove(col, roll))
+            return false;
+        if (!replaying)
+            record.addMove(col);
+        enterPhase(state.isTerminal() ? TurnPhase::GameOver : TurnPhase::WaitingForRoll);
+        return true;
+    }
 
+    void handleEvent(const sf::Event& event) {
+        if (event.type == sf::Event::Closed) {
+            running = false;
+            return;
+        }
+        if (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::F3) {
+            profiler.setEnabled(!profiler.isEnabled());
+            return;
+        }
 
-        while (window.isOpen() && running) {
-            sf::Event event;
-            while (window.pollEvent(event)) {
-                if (event.type == sf::Event::Closed) {
-                    window.close();
+        switch (phase) {
+        case TurnPhase::WaitingForRoll:
+            if (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::R && !isComputerTurn())
+                startRoll();
+            break;
+        case TurnPhase::Placing:
+            if (event.type == sf::Event::MouseButtonPressed && event.mouseButton.button == sf::Mouse::Left) {
+                sf::Vector2i mousePos(event.mouseButton.x, event.mouseButton.y);
+                sf::Vector2f gridPosition = gridPositions[state.sideToMove()];
+
+                // Check if the click is within the current player's grid
+                if (isValidClick(mousePos, gridPosition)) {
+                    int col = (mousePos.x - static_cast<int>(gridPosition.x)) / 70;
+                    if (col >= 0 && col < 3)
+                        placeDie(col);
                 }
+            }
+            break;
+        case TurnPhase::GameOver:
+            // Any key or click skips the rest of the result screen
+            if (event.type == sf::Event::KeyPressed || event.type == sf::Event::MouseButtonPressed)
+                running = false;
+            break;
+        default:
+            break;
+        }
+    }
 
-                if (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::R) {
-                    takeTurn(window, grid1Position, grid2Position, infoText);
+    // Advances timers and animation by one fixed step
+    void update(float dt) {
+        phaseTime += dt;
+        switch (phase) {
+        case TurnPhase::WaitingForRoll:
+            // A replay that runs out of moves stops where the record ends
+            if (replaying && state.turn >= record.moves)
+                enterPhase(TurnPhase::GameOver);
+            // The computer rolls for itself without waiting for a key press
+            else if (isComputerTurn())
+                startRoll();
+            break;
+        case TurnPhase::Rolling:
+            animation.update(dt);
+            if (phaseTime >= ROLL_TIME)
+                enterPhase(TurnPhase::ShowingRoll);
+            break;
+        case TurnPhase::ShowingRoll:
+            if (phaseTime < SHOW_TIME)
+                break;
+            if (replaying) {
+                if (!placeDie(record.column(state.turn))) {
+                    cerr << "Recorded move " << state.turn + 1 << " is illegal" << endl;
+                    enterPhase(TurnPhase::GameOver);
                 }
+            } else if (isComputerTurn()) {
+                // The computer picks its column straight away
+                placeDie(solved.isLoaded() ? solved.bestColumn(state, roll) : ai.chooseColumn(state, roll));
+            } else {
+                enterPhase(TurnPhase::Placing);
             }
-
-            window.clear(sf::Color::Black);
-            window.draw(logoSprite); // Draw logo
-
-            grid1.render(window, grid1Position, sf::Color::Red);
-            grid2.render(window, grid2Position, sf::Color::Blue);
-
-            infoText.setString((turn % 2 == 0 ? "Player 1" : "Player 2") + std::string("'s Turn\nPress 'R' to roll."));
-            infoText.setFillColor(turn % 2 == 0 ? sf::Color::Red : sf::Color::Blue);
-            window.draw(infoText);
-            window.display();
+            break;
+        case TurnPhase::Placing:
+            break;
+        case TurnPhase::GameOver:
+            if (phaseTime >= RESULT_TIME)
+                running = false;
+            break;
         }
-
-        endGame(window);
     }
 
-    void takeTurn(sf::RenderWindow& window, const sf::Vector2f& grid1Position, const sf::Vector2f& grid2Position, sf::Text& infoText) {
-        int roll = dice.roll();
-        Player& currentPlayer = turn % 2 == 0 ? player1 : player2;
-        Grid& currentGrid = turn % 2 == 0 ? grid1 : grid2;
-        sf::Vector2f gridPosition = turn % 2 == 0 ? grid1Position : grid2Position;
-
-        DiceAnimation diceAnimation(1.0f);
-        float elapsedTime = 0.0f;
-        sf::Clock clock;
+    // Draws the frame, charging each part of it to the profiler
+    void render(sf::RenderWindow& window) {
+        const sf::Texture* textTexture = &assets.getFont().getTexture(24);
 
-        // Animation loop
-        while (elapsedTime < 1.0f) {
-            elapsedTime += clock.restart().asSeconds();
-            diceAnimation.update(elapsedTime);
-            window.clear(sf::Color::Black);
-            grid1.render(window, grid1Position, sf::Color::Red);
-            grid2.render(window, grid2Position, sf::Color::Blue);
-            diceAnimation.draw(window, sf::Vector2f(300, 300));
-            infoText.setString(currentPlayer.getName() + "'s Turn");
+        window.clear(sf::Color::Black);
+        if (phase == TurnPhase::GameOver) {
+            window.draw(resultText);
+            profiler.countDraw(textTexture);
+        } else {
+            if (phase == TurnPhase::WaitingForRoll) {
+                window.draw(logoSprite); // Draw logo
+                profiler.countDraw(&assets.getLogo());
+            }
+            profiler.mark(FrameProfiler::DRAW);
+
+            boards[0].draw(window, state.grids[0], &profiler);
+            boards[1].draw(window, state.grids[1], &profiler);
+            profiler.mark(FrameProfiler::GRIDS);
+
+            if (phase == TurnPhase::Rolling) {
+                animation.draw(window, dicePosition);
+                profiler.countDraw(&assets.getAtlas());
+            } else if (phase == TurnPhase::ShowingRoll || phase == TurnPhase::Placing) {
+                face.draw(window, dicePosition);
+                profiler.countDraw(&assets.getAtlas());
+            }
             window.draw(infoText);
-            window.display();
+            profiler.countDraw(textTexture);
         }
+        profiler.mark(FrameProfiler::DRAW);
+
+        profiler.drawOverlay(window, assets.getFont());
+        profiler.mark(FrameProfiler::OVERLAY);
 
-        // Show rolled dice face
-        DiceFace diceFace;
-        diceFace.setFace(roll);
-        window.clear(sf::Color::Black);
-        grid1.render(window, grid1Position, sf::Color::Red);
-        grid2.render(window, grid2Position, sf::Color::Blue);
-        diceFace.draw(window, sf::Vector2f(300, 300));
-        infoText.setString(currentPlayer.getName() + "'s Turn\nRolled: " + to_string(roll));
-        window.draw(infoText);
         window.display();
+        profiler.mark(FrameProfiler::DISPLAY);
+    }
 
-        sf::sleep(sf::seconds(1.0f));
+    void showResult() {
+        GameScores scores = state.scores();
+        int score1 = scores.player1;
+        int score2 = scores.player2;
 
-        // Wait for a valid click
-        bool placed = false;
-        while (!placed) {
-            sf::Event event;
-            while (window.pollEvent(event)) {
-                if (event.type == sf::Event::Closed) {
-                    running = false;
-                    window.close();
-                    return;
-                }
-                if (event.type == sf::Event::MouseButtonPressed && event.mouseButton.button == sf::Mouse::Left) {
-                    sf::Vector2i mousePos(event.mouseButton.x, event.mouseButton.y);
-
-                    // Check if the click is within the current player's grid
-                    if (isValidClick(mousePos, gridPosition)) {
-                        int col = (mousePos.x - static_cast<int>(gridPosition.x)) / 70;
-                        if (col >= 0 && col < 3) {
-                            placed = currentGrid.placeDice(col, roll);
-                        }
-                    }
-                }
-            }
+        string result;
+        if (score1 > score2)
+            result = "Player 1 Wins!";
+        else if (score2 > score1)
+            result = "Player 2 Wins!";
+        else
+            result = "It's a Draw!";
+
+        resultText.setString("Game Over!\nPlayer 1: " + to_string(score1) + "\nPlayer 2: " + to_string(score2) + "\n" + result);
+    }
+
+public:
+    Game(bool computerPlayer2 = false, const string& solvedPath = "", bool vsync = false,
+         Rules rules = Rules())
+        : player1("Player 1"), player2(computerPlayer2 ? "Computer" : "Player 2"),
+          animation(assets, ROLL_TIME), face(assets), state(rules), ai(5.0), replaying(false),
+          phase(TurnPhase::WaitingForRoll), phaseTime(0), roll(1), computerPlayer2(computerPlayer2), vsync(vsync), running(true) {
+        record.clear(dice.getSeed());
+        if (!solvedPath.empty() && !rules.isStandard()) {
+            cerr << "The solved table only holds for the standard rules, using search instead" << endl;
+        } else if (!solvedPath.empty() && !solved.load(solvedPath)) {
+            cerr << "Error loading solved table " << solvedPath << ", using search instead" << endl;
         }
 
-        turn++;
-        checkGameOver();
+        // KNUCKLEBONES_PROFILE turns the profiler on from the start; any
+        // value other than 1 is the CSV file to write
+        const char* profile = getenv("KNUCKLEBONES_PROFILE");
+        profilePath = "knucklebones_frames.csv";
+        if (profile && *profile) {
+            profiler.setEnabled(true);
+            if (string(profile) != "1")
+                profilePath = profile;
+        }
     }
 
-    void checkGameOver() {
-        if (turn >= 18) {
-            running = false;
+    // Saves the game to a record file when it ends
+    void recordTo(const string& path) { recordPath = path; }
+
+        /**
+     * Public : replayFrom
+     *
+     * Description:
+     *      Loads one game from a record file. play() then shows it with the
+     *      recorded rolls and columns, and reports whether it ends with the
+     *      recorded scores.
+     *
+     * Params:
+     *      - const string& path : Record file (see record.hpp).
+     *      - long long index : Game to replay, counting from 0.
+     *
+     * Returns:
+     *      - bool : false if the file or the game cannot be read.
+     */
+    bool replayFrom(const string& path, long long index) {
+        RecordReader reader;
+        if (!reader.load(path))
+            return false;
+        for (long long g = 0; g <= index; ++g) {
+            if (!reader.next(record))
+                return false;
         }
+        dice = Dice(record.seed);
+        state = GameState(reader.rules());
+        replaying = true;
+        return true;
     }
 
-    void endGame(sf::RenderWindow& window) {
-        int score1 = grid1.calculateScore();
-        int score2 = grid2.calculateScore();
+    // Game loop: events, fixed-step updates and one draw per frame
+    void play() {
+        sf::RenderWindow window(sf::VideoMode(800, 600), "Knucklebones Game");
+        if (vsync)
+            window.setVerticalSyncEnabled(true);
+        else
+            window.setFramerateLimit(FRAME_RATE);
 
-        sf::Text resultText;
-        sf::Font font;
-        if (!font.loadFromFile("arial.ttf")) {
-            cerr << "Error loading font!" << endl;
-            exit(EXIT_FAILURE);
+        // Load every texture and the font up front
+        if (!assets.load()) {
+            return;
         }
+        const sf::Texture& logoTexture = assets.getLogo();
+        const sf::Font& font = assets.getFont();
+
+        logoSprite.setTexture(logoTexture);
+
+        // Resize logo to 200 pixels in width while maintaining aspect ratio
+        sf::Vector2u logoSize = logoTexture.getSize();
+        float logoScale = 200.0f / logoSize.x;
+        logoSprite.setScale(logoScale, logoScale);
+
+        // Center the logo at the top
+        float logoX = (window.getSize().x - logoSize.x * logoScale) / 2;
+        logoSprite.setPosition(logoX, 10);
+
+        // Grids sit slightly lower to make space for the logo
+        boards[0].setup(font, gridPositions[0], sf::Color::Red);
+        boards[1].setup(font, gridPositions[1], sf::Color::Blue);
+
+        // Text for instructions
+        infoText.setFont(font);
+        infoText.setCharacterSize(24); // Larger text for readability
+        infoText.setPosition(20, 500); // Positioned below grids
 
         resultText.setFont(font);
         resultText.setCharacterSize(24);
         resultText.setFillColor(sf::Color::White);
+        resultText.setPosition(200, 200);
 
-        string result;
-        if (score1 > score2)
-            result = "Player 1 Wins!";
-        else if (score2 > score1)
-            result = "Player 2 Wins!";
-        else
-            result = "It's a Draw!";
+        enterPhase(TurnPhase::WaitingForRoll);
 
-        resultText.setString("Game Over!\nPlayer 1: " + to_string(score1) + "\nPlayer 2: " + to_string(score2) + "\n" + result);
-        resultText.setPosition(200, 200);
+        sf::Clock clock;
+        float lag = 0;
+        while (window.isOpen() && running) {
+            profiler.beginFrame();
+            sf::Event event;
+            while (window.pollEvent(event)) {
+                handleEvent(event);
+            }
+            profiler.mark(FrameProfiler::EVENTS);
 
-        window.clear(sf::Color::Black);
-        window.draw(resultText);
-        window.display();
+            // Catch up in fixed steps so animation speed does not depend on frame rate
+            lag = min(lag + clock.restart().asSeconds(), MAX_LAG);
+            while (lag >= STEP && running) {
+                update(STEP);
+                lag -= STEP;
+            }
+            profiler.mark(FrameProfiler::UPDATE);
+
+            if (running) {
+                render(window);
+            }
+            profiler.endFrame();
+        }
+        window.close();
 
-        sf::sleep(sf::seconds(5));
+        if (profiler.wasUsed()) {
+            if (profiler.writeCsv(profilePath))
+                cout << "Frame timings written to " << profilePath << endl;
+            else
+                cerr << "Error writing frame timings to " << profilePath << endl;
+        }
     }
 };
 
-int main() {
-    Game game;
+int main(int argc, char* argv[]) {
+    bool computer = false;
+    bool vsync = false;
+    Rules rules;
+    string solvedPath, recordPath, replayPath;
+    long long replayIndex = 0;
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        if (arg == "--ai") {
+            computer = true;
+        } else if (arg == "--solved" && i + 1 < argc) {
+            computer = true;
+            solvedPath = argv[++i];
+        } else if (arg == "--vsync") {
+            vsync = true;
+        } else if (arg == "--classic") {
+            rules = Rules::classic();
+        } else if (arg == "--record" && i + 1 < argc) {
+            recordPath = argv[++i];
+        } else if (arg == "--replay" && i + 1 < argc) {
+            replayPath = argv[++i];
+            if (i + 1 < argc && argv[i + 1][0] != '-')
+                replayIndex = atoll(argv[++i]);
+        }
+    }
+
+    Game game(computer && replayPath.empty(), solvedPath, vsync, rules);
+    if (!replayPath.empty() && !game.replayFrom(replayPath, replayIndex)) {
+        cerr << "Error loading game " << replayIndex << " from " << replayPath << endl;
+        return 1;
+    }
+    if (!recordPath.empty())
+        game.recordTo(recordPath);
     game.play();
     return 0;
 }
@@ -0,0 +1,283 @@
+/*****************************************************************************
+*
+*  Author:           Jesus Mendoza
+*  Email:            jesus.kyx.mendoza11@gmail.com
+*  Label:            Program 2C - Knucklebones Game
+*  Title:            Match Server Load Generator
+*  Course:           CMPS 2143
+*  Semester:         Fall 2024
+*
+*  Description:
+*        Opens many connections to match_server.cpp and plays random legal
+*        moves on all of them from one epoll loop, keeping a fixed number
+*        of matches in flight until the requested number have finished.
+*
+*        Move latency is the time from sending MOVE to receiving the
+*        server's answer (the next TURN, or END), so it covers both trips
+*        over loopback and the server's work, including any queueing behind
+*        the other matches. The report gives the median, 99th percentile
+*        and worst latency, and the finished matches per second.
+*
+*        Linux only (epoll).
+*
+*  Usage:
+*        g++ -std=c++20 -O2 match_client.cpp -o match_client
+*        ./match_client [--port n] [--matches n] [--concurrency n] [--seed n]
+*                       [--timeout seconds]
+*
+*        --concurrency is the number of matches in flight (default 1000,
+*        two connections each); --matches the total (default 100000).
+*
+*  Files:
+*        match_client.cpp  : This load generator.
+*        match_server.cpp  : Server it talks to.
+*        protocol.hpp      : Message format.
+*
+*****************************************************************************/
+
+#include <sys/epoll.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+#include "protocol.hpp"
+
+using namespace std;
+using Clock = chrono::steady_clock;
+
+// One connection, playing one seat at a time
+struct Player {
+    int fd = -1;
+    int seat = 0;
+    Rules rules;
+    bool awaitingReply = false;      // Sent a MOVE, waiting for the answer
+    Clock::time_point sentAt;
+    uint8_t in[MAX_MESSAGE_LENGTH];  // Partial message
+    int inLength = 0;
+};
+
+// Totals for the report
+struct LoadStats {
+    long long joinsSent = 0;
+    long long finished = 0;
+    long long abandoned = 0;
+    long long moves = 0;
+    long long errors = 0;
+    vector<float> latencies;  // Microseconds
+};
+
+bool sendAll(int fd, const vector<uint8_t>& bytes) {
+    size_t sent = 0;
+    while (sent < bytes.size()) {
+        ssize_t n = send(fd, bytes.data() + sent, bytes.size() - sent, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            return false;
+        sent += static_cast<size_t>(n);
+    }
+    return true;
+}
+
+// Picks a random open column for the player to move and sends it
+bool sendMove(Player& player, const uint8_t* turnMessage, Dice& dice, LoadStats& stats) {
+    GameState state(player.rules);
+    state.turn = static_cast<int>(get16(turnMessage + 1));
+    state.grids[0] = Grid::fromPacked(get32(turnMessage + 4));
+    state.grids[1] = Grid::fromPacked(get32(turnMessage + 8));
+
+    int legal[3];
+    int count = 0;
+    for (int col = 0; col < 3; ++col)
+        if (state.isLegal(col))
+            legal[count++] = col;
+    if (count == 0)
+        return false;
+
+    vector<uint8_t> out;
+    encodeMove(out, state.turn, legal[dice.below(static_cast<uint32_t>(count))]);
+    player.awaitingReply = true;
+    player.sentAt = Clock::now();
+    stats.moves++;
+    return sendAll(player.fd, out);
+}
+
+// Queues for another match while matches remain to be played
+bool rejoin(Player& player, long long target, LoadStats& stats) {
+    if (stats.joinsSent >= 2 * target)
+        return true;
+    vector<uint8_t> out;
+    encodeJoin(out);
+    stats.joinsSent++;
+    return sendAll(player.fd, out);
+}
+
+// Acts on one complete message from the server
+bool handle(Player& player, const uint8_t* message, Dice& dice, long long target, LoadStats& stats) {
+    if (player.awaitingReply && (message[0] == MSG_TURN || message[0] == MSG_END)) {
+        auto elapsed = Clock::now() - player.sentAt;
+        stats.latencies.push_back(chrono::duration<float, micro>(elapsed).count());
+        player.awaitingReply = false;
+    }
+    switch (message[0]) {
+    case MSG_START:
+        player.seat = message[1];
+        player.rules = Rules::fromBits(message[2]);
+        return true;
+    case MSG_TURN:
+        if (static_cast<int>(get16(message + 1) & 1) == player.seat)
+            return sendMove(player, message, dice, stats);
+        return true;
+    case MSG_END:
+        if (player.seat == 0)
+            stats.finished++;
+        return rejoin(player, target, stats);
+    case MSG_ERROR:
+        player.awaitingReply = false;
+        if (message[1] == ERROR_OPPONENT_LEFT) {
+            stats.abandoned++;
+            return rejoin(player, target, stats);
+        }
+        stats.errors++;
+        cerr << "Server error " << static_cast<int>(message[1]) << endl;
+        return true;
+    }
+    return false;
+}
+
+float percentile(vector<float>& values, double fraction) {
+    if (values.empty())
+        return 0;
+    size_t index = static_cast<size_t>(fraction * static_cast<double>(values.size() - 1));
+    nth_element(values.begin(), values.begin() + static_cast<long>(index), values.end());
+    return values[index];
+}
+
+int main(int argc, char* argv[]) {
+    int port = DEFAULT_PORT;
+    long long target = 100000;
+    int concurrency = 1000;
+    unsigned long long seed = 1;
+    double timeout = 600;
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--port") == 0 && i + 1 < argc)
+            port = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--matches") == 0 && i + 1 < argc)
+            target = atoll(argv[++i]);
+        else if (strcmp(argv[i], "--concurrency") == 0 && i + 1 < argc)
+            concurrency = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc)
+            seed = strtoull(argv[++i], nullptr, 10);
+        else if (strcmp(argv[i], "--timeout") == 0 && i + 1 < argc)
+            timeout = atof(argv[++i]);
+    }
+    if (concurrency < 1)
+        concurrency = 1;
+    if (concurrency > target)
+        concurrency = static_cast<int>(target);
+
+    long files = raiseFileLimit();
+    if (files >= 0 && 2L * concurrency + 16 > files) {
+        cerr << "Need " << 2 * concurrency << " connections but only " << files << " descriptors are allowed"
+             << endl;
+        return 1;
+    }
+
+    int epollFd = epoll_create1(0);
+    LoadStats stats;
+    stats.latencies.reserve(static_cast<size_t>(target) * 20);
+    Dice dice(seed);
+
+    // Sockets stay blocking for the tiny writes; reads never wait
+    // because they only happen after epoll reports data
+    vector<Player> players(2 * static_cast<size_t>(concurrency));
+    sockaddr_in address = loopbackAddress(port);
+    for (size_t i = 0; i < players.size(); ++i) {
+        Player& player = players[i];
+        player.fd = socket(AF_INET, SOCK_STREAM, 0);
+        if (player.fd < 0 ||
+            connect(player.fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+            cerr << "Cannot connect to 127.0.0.1:" << port << ": " << strerror(errno) << endl;
+            return 1;
+        }
+        setNoDelay(player.fd);
+        epoll_event event{};
+        event.events = EPOLLIN;
+        event.data.u32 = static_cast<uint32_t>(i);
+        epoll_ctl(epollFd, EPOLL_CTL_ADD, player.fd, &event);
+    }
+
+    auto start = Clock::now();
+    for (Player& player : players)
+        rejoin(player, target, stats);
+
+    const int MAX_EVENTS = 1024;
+    epoll_event events[MAX_EVENTS];
+    uint8_t buffer[4096];
+    bool failed = false;
+    while (stats.finished + stats.abandoned < target && !failed) {
+        if (chrono::duration<double>(Clock::now() - start).count() > timeout) {
+            cerr << "Timed out" << endl;
+            failed = true;
+            break;
+        }
+        int count = epoll_wait(epollFd, events, MAX_EVENTS, 1000);
+        for (int e = 0; e < count && !failed && stats.finished + stats.abandoned < target; ++e) {
+            Player& player = players[events[e].data.u32];
+            ssize_t n = recv(player.fd, buffer, sizeof(buffer), MSG_DONTWAIT);
+            if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR))
+                continue;
+            if (n <= 0) {
+                cerr << "Server closed the connection" << endl;
+                failed = true;
+                break;
+            }
+            for (ssize_t i = 0; i < n;) {
+                if (player.inLength == 0 && messageLength(buffer[i]) == 0) {
+                    cerr << "Unknown message type " << static_cast<int>(buffer[i]) << endl;
+                    failed = true;
+                    break;
+                }
+                int length = messageLength(player.inLength > 0 ? player.in[0] : buffer[i]);
+                int take = min(static_cast<int>(n - i), length - player.inLength);
+                memcpy(player.in + player.inLength, buffer + i, static_cast<size_t>(take));
+                player.inLength += take;
+                i += take;
+                if (player.inLength == length) {
+                    player.inLength = 0;
+                    if (!handle(player, player.in, dice, target, stats)) {
+                        cerr << "Lost the connection to the server" << endl;
+                        failed = true;
+                        break;
+                    }
+                }
+            }
+        }
+    }
+    double seconds = chrono::duration<double>(Clock::now() - start).count();
+
+    for (Player& player : players)
+        close(player.fd);
+    close(epollFd);
+
+    cout << "Connections:  " << players.size() << " (" << concurrency << " matches in flight)" << endl;
+    cout << "Matches:      " << stats.finished << " finished";
+    if (stats.abandoned > 0)
+        cout << ", " << stats.abandoned << " abandoned";
+    cout << " in " << seconds << " s (" << static_cast<long long>(stats.finished / seconds) << " matches/second)"
+         << endl;
+    cout << "Moves:        " << stats.moves << " (" << static_cast<long long>(stats.moves / seconds)
+         << " moves/second)" << endl;
+    float p50 = percentile(stats.latencies, 0.50);
+    float p99 = percentile(stats.latencies, 0.99);
+    float worst = stats.latencies.empty() ? 0 : *max_element(stats.latencies.begin(), stats.latencies.end());
+    cout << "Move latency: p50 " << p50 << " us, p99 " << p99 << " us, max " << worst << " us" << endl;
+    if (stats.errors > 0)
+        cout << "Errors:       " << stats.errors << endl;
+    return failed || stats.errors > 0 ? 2 : 0;
+}
@@ -0,0 +1,519 @@
+/*****************************************************************************
+*
+*  Author:           Jesus Mendoza
+*  Email:            jesus.kyx.mendoza11@gmail.com
+*  Label:            Program 2C - Knucklebones Game
+*  Title:            Knucklebones Match Server
+*  Course:           CMPS 2143
+*  Semester:         Fall 2024
+*
+*  Description:
+*        Hosts many Knucklebones matches at once from one thread. Clients
+*        connect over TCP, JOIN, and are paired as they arrive; every match
+*        is a GameState plus the Dice the server rolls for it, so clients
+*        never see a roll before it is their turn and cannot choose their
+*        own. The messages are described in protocol.hpp.
+*
+*        One epoll loop watches the listening socket and every client.
+*        Sockets are non-blocking: whatever a client sends is buffered until
+*        a whole message has arrived, and replies go into a per-connection
+*        output buffer that is flushed once per loop pass, with EPOLLOUT
+*        requested only while a buffer cannot be written in full. Matches
+*        live in one vector and are reused through a free list, so a
+*        running server allocates almost nothing.
+*
+*        Match n of a run rolls with Dice((seed << 32) + n), the same
+*        scheme as simulate.cpp, so with --record every finished match is
+*        written to a record file that ./replay can check.
+*
+*        Linux only (epoll). Listens on the loopback interface.
+*
+*  Usage:
+*        g++ -std=c++20 -O2 match_server.cpp -o match_server
+*        ./match_server [--port n] [--seed n] [--classic] [--record file]
+*                       [--matches n]
+*
+*        --matches stops the server after that many finished matches;
+*        otherwise it runs until Ctrl+C. A status line is printed every
+*        five seconds.
+*
+*  Files:
+*        match_server.cpp  : This server.
+*        match_client.cpp  : Load generator.
+*        protocol.hpp      : Message format.
+*        record.hpp        : Records written with --record.
+*
+*****************************************************************************/
+
+#include <sys/epoll.h>
+
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "protocol.hpp"
+#include "record.hpp"
+
+using namespace std;
+
+volatile sig_atomic_t stopRequested = 0;
+
+void requestStop(int) { stopRequested = 1; }
+
+// One client socket
+struct Connection {
+    bool open = false;
+    int match = -1;                 // Index into the match table, -1 if none
+    int seat = 0;                   // 0 or 1 within the match
+    uint8_t in[MAX_MESSAGE_LENGTH]; // Partial message waiting for more bytes
+    int inLength = 0;
+    vector<uint8_t> out;            // Replies not yet written
+    size_t outOffset = 0;
+    bool dirty = false;             // Has output queued since the last flush
+    bool watchingWrite = false;     // EPOLLOUT requested
+    bool closing = false;           // Close once the output is flushed
+};
+
+// One game between two connections
+struct Match {
+    GameState state;
+    Dice dice;
+    int die = 0;        // Roll waiting for the player to move
+    int fds[2] = {-1, -1};
+    GameRecord record;
+    bool active = false;
+};
+
+/**
+ * Class Name: MatchServer
+ *
+ * Description:
+ *      The epoll loop, the connections and the match table.
+ *
+ * Public Methods:
+ *      - MatchServer(Rules rules, uint64_t seed, long long matchLimit)
+ *      - bool listenOn(int port)
+ *      - bool recordTo(const string& path)
+ *      - int run()
+ *
+ * Private Members:
+ *      - int epollFd, listenFd
+ *      - vector<Connection> connections
+ *      - vector<Match> matches
+ *      - vector<int> freeMatches
+ *      - vector<int> dirty
+ *      - int waiting
+ *      - RecordWriter writer
+ */
+class MatchServer {
+    Rules rules;
+    uint64_t seed;
+    long long matchLimit;      // Stop after this many finished matches (0: never)
+    int epollFd = -1;
+    int listenFd = -1;
+    vector<Connection> connections;  // Indexed by file descriptor
+    vector<Match> matches;
+    vector<int> freeMatches;
+    vector<int> dirty;               // Connections with output to flush
+    int waiting = -1;                // Connection waiting for an opponent
+    RecordWriter writer;
+
+    long long matchesStarted = 0;
+    long long matchesFinished = 0;
+    long long matchesAbandoned = 0;
+    long long movesPlayed = 0;
+    long long errorsSent = 0;
+    int openConnections = 0;
+    int activeMatches = 0;
+    int peakMatches = 0;
+
+    Connection& connection(int fd) { return connections[fd]; }
+
+    void watch(int fd, bool write) {
+        epoll_event event{};
+        event.events = write ? EPOLLIN | EPOLLOUT : EPOLLIN;
+        event.data.fd = fd;
+        epoll_ctl(epollFd, EPOLL_CTL_MOD, fd, &event);
+        connection(fd).watchingWrite = write;
+    }
+
+    // Marks a connection as having output to write this pass
+    vector<uint8_t>& output(int fd) {
+        Connection& c = connection(fd);
+        if (!c.dirty) {
+            c.dirty = true;
+            dirty.push_back(fd);
+        }
+        return c.out;
+    }
+
+    void sendError(int fd, ErrorCode code) {
+        encodeError(output(fd), code);
+        errorsSent++;
+    }
+
+    // Writes as much queued output as the socket takes
+    void flush(int fd) {
+        Connection& c = connection(fd);
+        while (c.outOffset < c.out.size()) {
+            ssize_t n = send(fd, c.out.data() + c.outOffset, c.out.size() - c.outOffset, MSG_NOSIGNAL);
+            if (n < 0) {
+                if (errno == EAGAIN || errno == EWOULDBLOCK)
+                    break;
+                if (errno == EINTR)
+                    continue;
+                closeConnection(fd);
+                return;
+            }
+            c.outOffset += static_cast<size_t>(n);
+        }
+        if (c.outOffset == c.out.size()) {
+            c.out.clear();
+            c.outOffset = 0;
+            if (c.closing) {
+                closeConnection(fd);
+                return;
+            }
+        }
+        bool pending = !c.out.empty();
+        if (pending != c.watchingWrite)
+            watch(fd, pending);
+    }
+
+    void acceptClients() {
+        while (true) {
+            int fd = accept4(listenFd, nullptr, nullptr, SOCK_NONBLOCK);
+            if (fd < 0) {
+                if (errno == EINTR)
+                    continue;
+                if (errno != EAGAIN && errno != EWOULDBLOCK)
+                    cerr << "accept: " << strerror(errno) << endl;
+                return;
+            }
+            setNoDelay(fd);
+            if (static_cast<size_t>(fd) >= connections.size())
+                connections.resize(static_cast<size_t>(fd) + 1);
+            connections[fd] = Connection();
+            connections[fd].open = true;
+            epoll_event event{};
+            event.events = EPOLLIN;
+            event.data.fd = fd;
+            epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &event);
+            openConnections++;
+        }
+    }
+
+    void closeConnection(int fd) {
+        Connection& c = connection(fd);
+        if (!c.open)
+            return;
+        if (c.match >= 0) {
+            Match& m = matches[c.match];
+            int other = m.fds[1 - c.seat];
+            connection(other).match = -1;
+            sendError(other, ERROR_OPPONENT_LEFT);
+            releaseMatch(c.match);
+            matchesAbandoned++;
+        }
+        if (waiting == fd)
+            waiting = -1;
+        epoll_ctl(epollFd, EPOLL_CTL_DEL, fd, nullptr);
+        close(fd);
+        c.open = false;
+        c.match = -1;
+        c.out.clear();
+        c.outOffset = 0;
+        openConnections--;
+    }
+
+    void releaseMatch(int index) {
+        matches[index].active = false;
+        freeMatches.push_back(index);
+        activeMatches--;
+    }
+
+    // Pairs two waiting connections and sends the first roll
+    void startMatch(int fd0, int fd1) {
+        int index;
+        if (!freeMatches.empty()) {
+            index = freeMatches.back();
+            freeMatches.pop_back();
+        } else {
+            index = static_cast<int>(matches.size());
+            matches.emplace_back();
+        }
+        Match& m = matches[index];
+        uint64_t gameSeed = (seed << 32) + static_cast<uint64_t>(matchesStarted++);
+        m.state = GameState(rules);
+        m.dice = Dice(gameSeed);
+        m.record.clear(gameSeed);
+        m.fds[0] = fd0;
+        m.fds[1] = fd1;
+        m.active = true;
+        m.die = m.dice.roll();
+        if (++activeMatches > peakMatches)
+            peakMatches = activeMatches;
+
+        for (int seat = 0; seat < 2; ++seat) {
+            Connection& c = connection(m.fds[seat]);
+            c.match = index;
+            c.seat = seat;
+            encodeStart(output(m.fds[seat]), seat, rules);
+            encodeTurn(output(m.fds[seat]), m.state, m.die);
+        }
+    }
+
+    void join(int fd) {
+        if (connection(fd).match >= 0 || waiting == fd) {
+            sendError(fd, ERROR_NOT_IN_MATCH);
+            return;
+        }
+        if (waiting < 0) {
+            waiting = fd;
+            return;
+        }
+        int first = waiting;
+        waiting = -1;
+        startMatch(first, fd);
+    }
+
+    void move(int fd, const uint8_t* message) {
+        Connection& c = connection(fd);
+        if (c.match < 0) {
+            sendError(fd, ERROR_NOT_IN_MATCH);
+            return;
+        }
+        int index = c.match;
+        Match& m = matches[index];
+        if (m.state.sideToMove() != c.seat) {
+            sendError(fd, ERROR_NOT_YOUR_TURN);
+            return;
+        }
+        if (static_cast<int>(get16(message + 1)) != m.state.turn) {
+            sendError(fd, ERROR_STALE_TURN);
+            return;
+        }
+        int col = message[3];
+        if (!m.state.applyMove(col, m.die)) {
+            sendError(fd, ERROR_ILLEGAL_MOVE);
+            return;
+        }
+        m.record.addMove(col);
+        movesPlayed++;
+
+        if (m.state.isTerminal()) {
+            for (int seat = 0; seat < 2; ++seat) {
+                encodeEnd(output(m.fds[seat]), m.state);
+                connection(m.fds[seat]).match = -1;
+            }
+            if (writer.isOpen() && m.state.turn <= MAX_RECORD_MOVES) {
+                m.record.finish(m.state);
+                writer.write(m.record);
+            }
+            releaseMatch(index);
+            matchesFinished++;
+            if (matchLimit > 0 && matchesFinished >= matchLimit)
+                stopRequested = 1;
+            return;
+        }
+
+        m.die = m.dice.roll();
+        for (int seat = 0; seat < 2; ++seat)
+            encodeTurn(output(m.fds[seat]), m.state, m.die);
+    }
+
+    // Reads what has arrived and handles every complete message
+    void receive(int fd) {
+        uint8_t buffer[4096];
+        while (true) {
+            ssize_t n = recv(fd, buffer, sizeof(buffer), 0);
+            if (n == 0) {
+                closeConnection(fd);
+                return;
+            }
+            if (n < 0) {
+                if (errno == EINTR)
+                    continue;
+                if (errno != EAGAIN && errno != EWOULDBLOCK)
+                    closeConnection(fd);
+                return;
+            }
+
+            for (ssize_t i = 0; i < n;) {
+                Connection& c = connection(fd);
+                if (c.closing)
+                    return;
+                uint8_t type = c.inLength > 0 ? c.in[0] : buffer[i];
+                if (type != MSG_JOIN && type != MSG_MOVE) {
+                    // Not a client message: report it and hang up
+                    sendError(fd, ERROR_BAD_MESSAGE);
+                    c.closing = true;
+                    return;
+                }
+                int length = messageLength(type);
+                int take = static_cast<int>(n - i) < length - c.inLength ? static_cast<int>(n - i)
+                                                                         : length - c.inLength;
+                memcpy(c.in + c.inLength, buffer + i, static_cast<size_t>(take));
+                c.inLength += take;
+                i += take;
+                if (c.inLength < length)
+                    break;
+                c.inLength = 0;
+                if (type == MSG_JOIN)
+                    join(fd);
+                else
+                    move(fd, c.in);
+            }
+        }
+    }
+
+    void printStatus(double seconds, long long movesBefore, double interval) const {
+        cout << fixed;
+        cout.precision(1);
+        cout << "[" << seconds << " s] connections " << openConnections << ", active matches " << activeMatches
+             << ", finished " << matchesFinished << ", " << static_cast<long long>((movesPlayed - movesBefore) / interval)
+             << " moves/second" << endl;
+    }
+
+public:
+    MatchServer(Rules rules, uint64_t seed, long long matchLimit)
+        : rules(rules), seed(seed), matchLimit(matchLimit) {}
+
+    ~MatchServer() {
+        for (size_t fd = 0; fd < connections.size(); ++fd)
+            if (connections[fd].open)
+                close(static_cast<int>(fd));
+        if (listenFd >= 0)
+            close(listenFd);
+        if (epollFd >= 0)
+            close(epollFd);
+    }
+
+    // Opens the listening socket on the loopback interface
+    bool listenOn(int port) {
+        listenFd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK, 0);
+        if (listenFd < 0)
+            return false;
+        int on = 1;
+        setsockopt(listenFd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+        sockaddr_in address = loopbackAddress(port);
+        if (bind(listenFd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 ||
+            listen(listenFd, SOMAXCONN) != 0)
+            return false;
+
+        epollFd = epoll_create1(0);
+        if (epollFd < 0)
+            return false;
+        epoll_event event{};
+        event.events = EPOLLIN;
+        event.data.fd = listenFd;
+        return epoll_ctl(epollFd, EPOLL_CTL_ADD, listenFd, &event) == 0;
+    }
+
+    bool recordTo(const string& path) { return writer.open(path, rules); }
+
+    // Serves until Ctrl+C or the match limit; returns the exit code
+    int run() {
+        const int MAX_EVENTS = 1024;
+        epoll_event events[MAX_EVENTS];
+        auto start = chrono::steady_clock::now();
+        auto lastStatus = start;
+        long long movesAtStatus = 0;
+
+        while (!stopRequested) {
+            int count = epoll_wait(epollFd, events, MAX_EVENTS, 1000);
+            if (count < 0 && errno != EINTR) {
+                cerr << "epoll_wait: " << strerror(errno) << endl;
+                return 1;
+            }
+            for (int i = 0; i < count; ++i) {
+                int fd = events[i].data.fd;
+                if (fd == listenFd) {
+                    acceptClients();
+                    continue;
+                }
+                if (!connection(fd).open)
+                    continue;
+                if (events[i].events & (EPOLLERR | EPOLLHUP)) {
+                    closeConnection(fd);
+                    continue;
+                }
+                if (events[i].events & EPOLLIN)
+                    receive(fd);
+                if (connection(fd).open && (events[i].events & EPOLLOUT))
+                    flush(fd);
+            }
+
+            // One write per connection per pass, however many replies it got
+            for (size_t i = 0; i < dirty.size(); ++i) {
+                int fd = dirty[i];
+                connection(fd).dirty = false;
+                if (connection(fd).open)
+                    flush(fd);
+            }
+            dirty.clear();
+
+            auto now = chrono::steady_clock::now();
+            double sinceStatus = chrono::duration<double>(now - lastStatus).count();
+            if (sinceStatus >= 5.0) {
+                printStatus(chrono::duration<double>(now - start).count(), movesAtStatus, sinceStatus);
+                lastStatus = now;
+                movesAtStatus = movesPlayed;
+            }
+        }
+
+        double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        cout << "Matches:      " << matchesFinished << " finished, " << matchesAbandoned << " abandoned, peak "
+             << peakMatches << " at once" << endl;
+        cout << "Moves:        " << movesPlayed << " (" << static_cast<long long>(movesPlayed / seconds)
+             << " moves/second)" << endl;
+        cout << "Errors sent:  " << errorsSent << endl;
+        if (!writer.close()) {
+            cerr << "Error writing the record file" << endl;
+            return 1;
+        }
+        return 0;
+    }
+};
+
+int main(int argc, char* argv[]) {
+    int port = DEFAULT_PORT;
+    unsigned long long seed = 1;
+    long long matchLimit = 0;
+    Rules rules;
+    string recordPath;
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--port") == 0 && i + 1 < argc)
+            port = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc)
+            seed = strtoull(argv[++i], nullptr, 10);
+        else if (strcmp(argv[i], "--matches") == 0 && i + 1 < argc)
+            matchLimit = atoll(argv[++i]);
+        else if (strcmp(argv[i], "--classic") == 0)
+            rules = Rules::classic();
+        else if (strcmp(argv[i], "--record") == 0 && i + 1 < argc)
+            recordPath = argv[++i];
+    }
+
+    signal(SIGINT, requestStop);
+    signal(SIGTERM, requestStop);
+    signal(SIGPIPE, SIG_IGN);
+    long files = raiseFileLimit();
+
+    MatchServer server(rules, seed, matchLimit);
+    if (!server.listenOn(port)) {
+        cerr << "Cannot listen on port " << port << ": " << strerror(errno) << endl;
+        return 1;
+    }
+    if (!recordPath.empty() && !server.recordTo(recordPath)) {
+        cerr << "Error creating record file " << recordPath << endl;
+        return 1;
+    }
+    cout << "Listening on 127.0.0.1:" << port << " (up to " << files << " descriptors)" << endl;
+    return server.run();
+}
@@ -0,0 +1,312 @@
+/*****************************************************************************
+*
+*  Author:           Jesus Mendoza
+*  Email:            jesus.kyx.mendoza11@gmail.com
+*  Label:            Program 2C - Knucklebones Game
+*  Title:            Monte Carlo Tree Search Computer Player
+*  Course:           CMPS 2143
+*  Semester:         Fall 2024
+*
+*  Description:
+*        A computer player that needs nothing but the rules in GameState, so
+*        it keeps working for rule variants whose game tree is too large to
+*        search exactly or solve.
+*
+*        Every thread grows its own search tree from the current position
+*        (root parallelization) and the root statistics are added up at the
+*        end. Trees are never shared, so there are no locks or atomics on
+*        the hot path and every core runs at full speed. Each iteration walks
+*        the tree with UCB1 at decision nodes, samples the die at chance
+*        nodes, adds one node, finishes the game with random moves and
+*        credits the result back along the path. Playouts can instead use
+*        the column value tables (see column_values.hpp), which cost a few
+*        loads per move and give far more realistic games than random play.
+*
+*  Usage:
+*        MctsAI ai(20.0);                      // 20 ms per move, all cores
+*        int col = ai.chooseColumn(state, die);
+*        double rate = ai.lastStats().playoutsPerSecond;
+*
+*****************************************************************************/
+
+#pragma once
+
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include "column_values.hpp"
+#include "engine.hpp"
+
+// Counters from the most recent call to chooseColumn()
+struct MctsStats {
+    long long playouts;        // Iterations over all threads
+    int threads;               // Trees searched in parallel
+    double milliseconds;       // Wall time spent
+    double playoutsPerSecond;  // playouts / wall time
+};
+
+/**
+ * Class Name: MctsAI
+ *
+ * Description:
+ *      Root-parallel Monte Carlo Tree Search. The move with the most visits
+ *      summed over all trees is played.
+ *
+ * Public Methods:
+ *      - MctsAI(double budgetMs = 20.0, int threads = 0, long long maxPlayouts = 0,
+ *               double exploration = 0.7, std::uint64_t seed = 0x6D637473,
+ *               bool tablePlayouts = false)
+ *      - int chooseColumn(const GameState& state, int die)
+ *      - const MctsStats& lastStats() const
+ *
+ * Private Members:
+ *      - std::vector<Tree> trees
+ *      - double budgetMs
+ *      - long long maxPlayouts
+ *      - double exploration
+ *      - bool tablePlayouts
+ *      - MctsStats stats
+ *
+ * Usage:
+ *      MctsAI ai(0, 4, 10000);   // No time limit, 4 threads, 10000 playouts each
+ *      int col = ai.chooseColumn(state, die);
+ */
+class MctsAI {
+    // Decision node: a position plus the die its mover must place
+    struct Node {
+        std::int32_t visits;
+        std::int32_t edgeVisits[3];
+        float edgeReward[3];             // Sum of results for the mover
+        std::int32_t children[3][6];     // Next decision node per column and roll, -1 if none
+    };
+
+    // One thread's tree and dice
+    struct Tree {
+        std::vector<Node> nodes;
+        Dice dice;
+        long long playouts;
+        std::int32_t rootVisits[3];
+    };
+
+    // Stop adding nodes past this many per tree; iterations continue with
+    // playouts from the frontier
+    static constexpr std::size_t MAX_NODES = 1 << 20;
+
+    std::vector<Tree> trees;
+    double budgetMs;
+    long long maxPlayouts;
+    double exploration;
+    bool tablePlayouts;  // Playouts follow tableColumn() instead of random moves
+    MctsStats stats;
+
+    static int newNode(Tree& tree) {
+        Node node{};
+        for (auto& column : node.children)
+            for (auto& child : column)
+                child = -1;
+        tree.nodes.push_back(node);
+        return static_cast<int>(tree.nodes.size() - 1);
+    }
+
+    static int rollDie(Tree& tree) {
+        return tree.dice.roll();
+    }
+
+    static int randomColumn(Tree& tree, const GameState& state) {
+        int legal[3];
+        int count = 0;
+        for (int col = 0; col < 3; ++col)
+            if (state.isLegal(col))
+                legal[count++] = col;
+        return legal[tree.dice.below(count)];
+    }
+
+    // Move made for the side to move during a playout
+    int playoutColumn(Tree& tree, const GameState& state, int die) const {
+        return tablePlayouts ? tableColumn(state, die) : randomColumn(tree, state);
+    }
+
+    // UCB1 over the legal columns; unvisited columns are tried first
+    int selectColumn(const Node& node, const GameState& state) const {
+        int best = -1;
+        double bestScore = -1;
+        double logVisits = std::log(static_cast<double>(node.visits) + 1);
+        for (int col = 0; col < 3; ++col) {
+            if (!state.isLegal(col))
+                continue;
+            if (node.edgeVisits[col] == 0)
+                return col;
+            double n = node.edgeVisits[col];
+            double score = node.edgeReward[col] / n + exploration * std::sqrt(logVisits / n);
+            if (score > bestScore) {
+                bestScore = score;
+                best = col;
+            }
+        }
+        return best;
+    }
+
+    // Result of a finished game for one player: 1 win, 0.5 draw, 0 loss
+    static float reward(const GameState& state, int player) {
+        GameScores s = state.scores();
+        int diff = player == 0 ? s.player1 - s.player2 : s.player2 - s.player1;
+        return diff > 0 ? 1.0f : diff == 0 ? 0.5f : 0.0f;
+    }
+
+    // One selection, expansion, playout and backpropagation pass
+    void iterate(Tree& tree, const GameState& root, int rootDie) const {
+        struct Step {
+            int node;
+            int col;
+            int mover;
+        };
+        Step path[64];
+        int length = 0;
+
+        GameState state = root;
+        int node = 0;
+        int die = rootDie;
+        while (true) {
+            int col = selectColumn(tree.nodes[node], state);
+            path[length++] = {node, col, state.sideToMove()};
+            state.applyMove(col, die);
+            if (state.isTerminal() || length == 64)
+                break;
+
+            die = rollDie(tree);
+            int child = tree.nodes[node].children[col][die - 1];
+            if (child < 0) {
+                if (tree.nodes.size() < MAX_NODES) {
+                    child = newNode(tree);
+                    tree.nodes[node].children[col][die - 1] = child;
+                    path[length++] = {child, -1, state.sideToMove()};
+                }
+                // Random playout from the new leaf
+                state.applyMove(playoutColumn(tree, state, die), die);
+                while (!state.isTerminal()) {
+                    die = rollDie(tree);
+                    state.applyMove(playoutColumn(tree, state, die), die);
+                }
+                break;
+            }
+            node = child;
+        }
+
+        float results[2] = {reward(state, 0), reward(state, 1)};
+        for (int i = 0; i < length; ++i) {
+            Node& n = tree.nodes[path[i].node];
+            n.visits++;
+            if (path[i].col >= 0) {
+                n.edgeVisits[path[i].col]++;
+                n.edgeReward[path[i].col] += results[path[i].mover];
+            }
+        }
+        tree.playouts++;
+    }
+
+    // Body of one worker thread
+    void search(Tree& tree, const GameState& state, int die,
+                std::chrono::steady_clock::time_point deadline) const {
+        tree.nodes.clear();
+        tree.playouts = 0;
+        newNode(tree);
+
+        while (true) {
+            if (maxPlayouts > 0 && tree.playouts >= maxPlayouts)
+                break;
+            if (budgetMs > 0 && (tree.playouts & 63) == 0 && std::chrono::steady_clock::now() >= deadline)
+                break;
+            iterate(tree, state, die);
+        }
+
+        for (int col = 0; col < 3; ++col)
+            tree.rootVisits[col] = tree.nodes[0].edgeVisits[col];
+    }
+
+public:
+    /**
+     * Public : MctsAI
+     *
+     * Description:
+     *      Sets the search limits and creates one tree per thread. Each tree
+     *      gets its own non-overlapping stream of dice from one seed.
+     *
+     * Params:
+     *      - double budgetMs : Wall time per move in milliseconds (0 for no limit).
+     *      - int threads : Trees to search in parallel (0 uses every core).
+     *      - long long maxPlayouts : Playouts per thread per move (0 for no limit).
+     *      - double exploration : UCB1 exploration constant.
+     *      - std::uint64_t seed : Seed for the playout dice.
+     *      - bool tablePlayouts : Play out games with tableColumn() instead of random moves.
+     *
+     * Returns:
+     *      - None
+     */
+    explicit MctsAI(double budgetMs = 20.0, int threads = 0, long long maxPlayouts = 0,
+                    double exploration = 0.7, std::uint64_t seed = 0x6D637473, bool tablePlayouts = false)
+        : budgetMs(budgetMs), maxPlayouts(maxPlayouts), exploration(exploration), tablePlayouts(tablePlayouts),
+          stats{} {
+        if (threads <= 0)
+            threads = static_cast<int>(std::thread::hardware_concurrency());
+        Dice dice(seed);
+        for (int i = 0; i < (threads > 0 ? threads : 1); ++i) {
+            trees.push_back(Tree{{}, dice, 0, {0, 0, 0}});
+            dice.jump();
+        }
+        if (budgetMs <= 0 && maxPlayouts <= 0)
+            this->maxPlayouts = 1000;  // Never search forever
+    }
+
+    /**
+     * Public : chooseColumn
+     *
+     * Description:
+     *      Searches the position on every thread and plays the column with
+     *      the most visits over all trees.
+     *
+     * Params:
+     *      - const GameState& state : Position with the player to move.
+     *      - int die : The value the player rolled (1-6).
+     *
+     * Returns:
+     *      - int : The column to play (0-2).
+     */
+    int chooseColumn(const GameState& state, int die) {
+        auto start = std::chrono::steady_clock::now();
+        auto deadline = start + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                                    std::chrono::duration<double, std::milli>(budgetMs));
+
+        std::vector<std::thread> workers;
+        for (std::size_t i = 1; i < trees.size(); ++i)
+            workers.emplace_back([this, i, &state, die, deadline] { search(trees[i], state, die, deadline); });
+        search(trees[0], state, die, deadline);
+        for (auto& worker : workers)
+            worker.join();
+
+        long long visits[3] = {0, 0, 0};
+        stats.playouts = 0;
+        for (const Tree& tree : trees) {
+            stats.playouts += tree.playouts;
+            for (int col = 0; col < 3; ++col)
+                visits[col] += tree.rootVisits[col];
+        }
+
+        int best = -1;
+        for (int col = 0; col < 3; ++col) {
+            if (state.isLegal(col) && (best < 0 || visits[col] > visits[best]))
+                best = col;
+        }
+
+        stats.threads = static_cast<int>(trees.size());
+        stats.milliseconds =
+            std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        stats.playoutsPerSecond = stats.milliseconds > 0 ? stats.playouts * 1000.0 / stats.milliseconds : 0;
+        return best;
+    }
+
+    // Counters from the last search
+    const MctsStats& lastStats() const { return stats; }
+};
@@ -0,0 +1,185 @@
+/*****************************************************************************
+*
+*  Author:           Jesus Mendoza
+*  Email:            jesus.kyx.mendoza11@gmail.com
+*  Label:            Program 2C - Knucklebones Game
+*  Title:            Match Server Protocol
+*  Course:           CMPS 2143
+*  Semester:         Fall 2024
+*
+*  Description:
+*        The binary protocol spoken between match_server.cpp and its
+*        clients over TCP. Every message starts with a one-byte type, and
+*        each type has a fixed length, so a reader knows how many bytes to
+*        wait for from the first byte alone. Numbers are little-endian.
+*
+*            Client to server
+*              JOIN   type                                  1 byte
+*              MOVE   type, turn (u16), column              4 bytes
+*
+*            Server to client
+*              START  type, seat (0 or 1), rules bits       3 bytes
+*              TURN   type, turn (u16), die, grids (2 x u32) 12 bytes
+*              END    type, turn (u16), grids, scores (2 x u8) 13 bytes
+*              ERROR  type, code                            2 bytes
+*
+*        A client sends JOIN and is paired with the next client that does.
+*        Both get START with their seat, then TURN after every move with
+*        the die the server rolled for the player to move (seat turn & 1)
+*        and both packed grids (see engine.hpp). The player to move answers
+*        with MOVE, echoing the turn so a late move is never applied to the
+*        wrong position. END closes the match, after which the connection
+*        may JOIN again.
+*
+*        The socket helpers below are Linux/POSIX only.
+*
+*  Usage:
+*        std::vector<std::uint8_t> out;
+*        encodeTurn(out, state, die);
+*        int length = messageLength(out[0]);   // 12
+*
+*****************************************************************************/
+
+#pragma once
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <cstdint>
+#include <vector>
+
+#include "engine.hpp"
+
+constexpr int DEFAULT_PORT = 4883;
+
+// Message types
+enum MessageType : std::uint8_t {
+    MSG_JOIN = 1,
+    MSG_MOVE = 2,
+    MSG_START = 16,
+    MSG_TURN = 17,
+    MSG_END = 18,
+    MSG_ERROR = 19
+};
+
+// Codes carried by MSG_ERROR
+enum ErrorCode : std::uint8_t {
+    ERROR_BAD_MESSAGE = 1,  // Unknown type; the server closes the connection
+    ERROR_NOT_IN_MATCH = 2, // MOVE without a match, or JOIN while in one
+    ERROR_NOT_YOUR_TURN = 3,
+    ERROR_STALE_TURN = 4,   // MOVE for a turn that is not the current one
+    ERROR_ILLEGAL_MOVE = 5, // Column full or out of range
+    ERROR_OPPONENT_LEFT = 6 // The match is over without a result
+};
+
+constexpr int MAX_MESSAGE_LENGTH = 13;
+
+// Length of a whole message given its type, or 0 for an unknown type
+constexpr int messageLength(std::uint8_t type) {
+    switch (type) {
+    case MSG_JOIN:
+        return 1;
+    case MSG_MOVE:
+        return 4;
+    case MSG_START:
+        return 3;
+    case MSG_TURN:
+        return 12;
+    case MSG_END:
+        return 13;
+    case MSG_ERROR:
+        return 2;
+    }
+    return 0;
+}
+
+inline void put16(std::vector<std::uint8_t>& out, unsigned value) {
+    out.push_back(static_cast<std::uint8_t>(value));
+    out.push_back(static_cast<std::uint8_t>(value >> 8));
+}
+
+inline void put32(std::vector<std::uint8_t>& out, std::uint32_t value) {
+    for (int shift = 0; shift < 32; shift += 8)
+        out.push_back(static_cast<std::uint8_t>(value >> shift));
+}
+
+inline unsigned get16(const std::uint8_t* p) { return p[0] | p[1] << 8; }
+
+inline std::uint32_t get32(const std::uint8_t* p) {
+    return p[0] | p[1] << 8 | p[2] << 16 | static_cast<std::uint32_t>(p[3]) << 24;
+}
+
+inline void encodeJoin(std::vector<std::uint8_t>& out) { out.push_back(MSG_JOIN); }
+
+inline void encodeMove(std::vector<std::uint8_t>& out, int turn, int col) {
+    out.push_back(MSG_MOVE);
+    put16(out, static_cast<unsigned>(turn));
+    out.push_back(static_cast<std::uint8_t>(col));
+}
+
+inline void encodeStart(std::vector<std::uint8_t>& out, int seat, Rules rules) {
+    out.push_back(MSG_START);
+    out.push_back(static_cast<std::uint8_t>(seat));
+    out.push_back(static_cast<std::uint8_t>(rules.bits()));
+}
+
+inline void encodeTurn(std::vector<std::uint8_t>& out, const GameState& state, int die) {
+    out.push_back(MSG_TURN);
+    put16(out, static_cast<unsigned>(state.turn));
+    out.push_back(static_cast<std::uint8_t>(die));
+    put32(out, state.grids[0].packed());
+    put32(out, state.grids[1].packed());
+}
+
+inline void encodeEnd(std::vector<std::uint8_t>& out, const GameState& state) {
+    GameScores s = state.scores();
+    out.push_back(MSG_END);
+    put16(out, static_cast<unsigned>(state.turn));
+    put32(out, state.grids[0].packed());
+    put32(out, state.grids[1].packed());
+    out.push_back(static_cast<std::uint8_t>(s.player1));
+    out.push_back(static_cast<std::uint8_t>(s.player2));
+}
+
+inline void encodeError(std::vector<std::uint8_t>& out, ErrorCode code) {
+    out.push_back(MSG_ERROR);
+    out.push_back(code);
+}
+
+// Makes reads and writes on a socket return instead of waiting
+inline bool setNonBlocking(int fd) {
+    int flags = fcntl(fd, F_GETFL, 0);
+    return flags >= 0 && fcntl(fd, F_SETFL, flags | O_NONBLOCK) == 0;
+}
+
+// Sends small messages at once instead of waiting to fill a packet
+inline void setNoDelay(int fd) {
+    int on = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+}
+
+// Raises the open file limit to the hard limit, since every connection
+// is a descriptor; returns the new soft limit
+inline long raiseFileLimit() {
+    rlimit limit;
+    if (getrlimit(RLIMIT_NOFILE, &limit) != 0)
+        return -1;
+    limit.rlim_cur = limit.rlim_max;
+    setrlimit(RLIMIT_NOFILE, &limit);
+    getrlimit(RLIMIT_NOFILE, &limit);
+    return static_cast<long>(limit.rlim_cur);
+}
+
+// IPv4 loopback address for a port
+inline sockaddr_in loopbackAddress(int port) {
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(static_cast<std::uint16_t>(port));
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    return address;
+}
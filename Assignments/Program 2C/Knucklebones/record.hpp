@@ -0,0 +1,363 @@
+/*****************************************************************************
+*
+*  Author:           Jesus Mendoza
+*  Email:            jesus.kyx.mendoza11@gmail.com
+*  Label:            Program 2C - Knucklebones Game
+*  Title:            Compact Game Records
+*  Course:           CMPS 2143
+*  Semester:         Fall 2024
+*
+*  Description:
+*        A game is fully determined by the seed of its dice and the column
+*        chosen on every turn, so that is all a record keeps. The rolls are
+*        recreated with Dice(seed).roll(), one per turn, and the final
+*        scores are stored so a replay can check that the engine still
+*        scores the game the same way.
+*
+*        A record file is a 16-byte header followed by one entry per game:
+*
+*            seed     varint of the zigzag difference from the previous
+*                     game's seed (1 byte for consecutive seeds)
+*            moves    one byte, the number of turns
+*            columns  2 bits per turn, four turns per byte
+*            scores   one byte per player
+*
+*        A standard game takes 9 bytes when seeds are consecutive, and at
+*        most 18 bytes with arbitrary seeds. The header records the rule
+*        variant (Rules::bits()) every game in the file was played under.
+*
+*  Usage:
+*        RecordWriter writer;
+*        writer.open("games.kbr", state.rules);
+*        GameRecord record(seed);
+*        record.addMove(col);                    // After every move
+*        record.finish(state);
+*        writer.write(record);
+*
+*        RecordReader reader;
+*        reader.load("games.kbr");
+*        while (reader.next(record))
+*            ok = replayGame(record, reader.rules()) == ReplayStatus::OK;
+*
+*****************************************************************************/
+
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "engine.hpp"
+
+// Header at the start of every record file
+struct RecordHeader {
+    char magic[8];          // "KBRECORD"
+    std::uint32_t version;  // RECORD_VERSION
+    std::uint32_t rules;    // Rules::bits(), 0 for the standard rules
+};
+
+constexpr std::uint32_t RECORD_VERSION = 1;
+constexpr int MAX_RECORD_MOVES = 255;  // The move count is one byte
+
+/**
+ * Class Name: GameRecord
+ *
+ * Description:
+ *      The seed, column choices and final scores of one game.
+ *
+ * Public Methods:
+ *      - GameRecord(std::uint64_t seed = 0)
+ *      - void clear(std::uint64_t seed)
+ *      - bool addMove(int col)
+ *      - int column(int move) const
+ *      - void finish(const GameState& state)
+ *
+ * Public Members:
+ *      - std::uint64_t seed
+ *      - int moves
+ *      - std::uint8_t columns[64]
+ *      - std::uint8_t scores[2]
+ */
+struct GameRecord {
+    std::uint64_t seed;                                // Seed of the game's Dice
+    int moves;                                         // Turns played
+    std::uint8_t columns[(MAX_RECORD_MOVES + 3) / 4];  // 2 bits per turn
+    std::uint8_t scores[2];                            // Final score of each player
+
+    explicit GameRecord(std::uint64_t seed = 0) { clear(seed); }
+
+    void clear(std::uint64_t newSeed) {
+        seed = newSeed;
+        moves = 0;
+        std::memset(columns, 0, sizeof(columns));
+        scores[0] = scores[1] = 0;
+    }
+
+    // Appends a move; false if the record is full
+    bool addMove(int col) {
+        if (moves >= MAX_RECORD_MOVES)
+            return false;
+        columns[moves / 4] |= static_cast<std::uint8_t>(col << (2 * (moves % 4)));
+        moves++;
+        return true;
+    }
+
+    int column(int move) const { return (columns[move / 4] >> (2 * (move % 4))) & 3; }
+
+    // Stores the final scores of a finished game
+    void finish(const GameState& state) {
+        GameScores s = state.scores();
+        scores[0] = static_cast<std::uint8_t>(s.player1);
+        scores[1] = static_cast<std::uint8_t>(s.player2);
+    }
+};
+
+// Appends one record to a byte buffer, with its seed relative to the
+// previous record's seed (which is then updated)
+inline void encodeRecord(const GameRecord& record, std::uint64_t& previousSeed, std::vector<std::uint8_t>& out) {
+    std::uint64_t delta = record.seed - previousSeed;
+    std::uint64_t zigzag = (delta << 1) ^ static_cast<std::uint64_t>(static_cast<std::int64_t>(delta) >> 63);
+    previousSeed = record.seed;
+    while (zigzag >= 0x80) {
+        out.push_back(static_cast<std::uint8_t>(zigzag | 0x80));
+        zigzag >>= 7;
+    }
+    out.push_back(static_cast<std::uint8_t>(zigzag));
+
+    out.push_back(static_cast<std::uint8_t>(record.moves));
+    out.insert(out.end(), record.columns, record.columns + (record.moves + 3) / 4);
+    out.push_back(record.scores[0]);
+    out.push_back(record.scores[1]);
+}
+
+// Reads one record and advances p; false if the data ends early
+inline bool decodeRecord(const std::uint8_t*& p, const std::uint8_t* end, std::uint64_t& previousSeed,
+                         GameRecord& record) {
+    std::uint64_t zigzag = 0;
+    for (int shift = 0;; shift += 7) {
+        if (p == end || shift > 63)
+            return false;
+        std::uint8_t byte = *p++;
+        zigzag |= static_cast<std::uint64_t>(byte & 0x7F) << shift;
+        if (!(byte & 0x80))
+            break;
+    }
+    if (p == end)
+        return false;
+
+    record.clear(previousSeed + ((zigzag >> 1) ^ (0ull - (zigzag & 1))));
+    previousSeed = record.seed;
+    record.moves = *p++;
+    int bytes = (record.moves + 3) / 4;
+    if (end - p < bytes + 2)
+        return false;
+    std::memcpy(record.columns, p, bytes);
+    p += bytes;
+    record.scores[0] = *p++;
+    record.scores[1] = *p++;
+    return true;
+}
+
+// Outcome of replaying a record
+enum class ReplayStatus {
+    OK,              // Every move legal and the final scores match
+    ILLEGAL_MOVE,    // A recorded column was full
+    UNFINISHED,      // The moves ran out before the game ended
+    EXTRA_MOVES,     // The game ended before the moves ran out
+    SCORE_MISMATCH   // The engine scores the final grids differently
+};
+
+/**
+ * Function Name: replayGame
+ *
+ * Description:
+ *      Plays a record through the engine: one roll of Dice(seed) per turn,
+ *      placed in the recorded column, then compares the final scores.
+ *
+ * Params:
+ *      - const GameRecord& record : The game to replay.
+ *      - Rules rules : Variant the game was played under (see RecordReader::rules()).
+ *      - GameState* final : Receives the final position, if not null.
+ *
+ * Returns:
+ *      - ReplayStatus : OK, or the first thing that went wrong.
+ */
+inline ReplayStatus replayGame(const GameRecord& record, Rules rules = Rules(), GameState* final = nullptr) {
+    Dice dice(record.seed);
+    GameState state(rules);
+    ReplayStatus status = ReplayStatus::OK;
+    for (int move = 0; move < record.moves; ++move) {
+        if (state.isTerminal()) {
+            status = ReplayStatus::EXTRA_MOVES;
+            break;
+        }
+        if (!state.applyMove(record.column(move), dice.roll())) {
+            status = ReplayStatus::ILLEGAL_MOVE;
+            break;
+        }
+    }
+    if (status == ReplayStatus::OK) {
+        GameScores s = state.scores();
+        if (!state.isTerminal())
+            status = ReplayStatus::UNFINISHED;
+        else if (s.player1 != record.scores[0] || s.player2 != record.scores[1])
+            status = ReplayStatus::SCORE_MISMATCH;
+    }
+    if (final)
+        *final = state;
+    return status;
+}
+
+/**
+ * Class Name: RecordWriter
+ *
+ * Description:
+ *      Appends records to a file through a buffer, so millions of games
+ *      can be written with a handful of system calls.
+ *
+ * Public Methods:
+ *      - bool open(const std::string& path, Rules rules = Rules())
+ *      - void write(const GameRecord& record)
+ *      - bool close()
+ *
+ * Private Members:
+ *      - std::FILE* file
+ *      - std::vector<std::uint8_t> buffer
+ *      - std::uint64_t previousSeed
+ *      - bool failed
+ */
+class RecordWriter {
+    static constexpr std::size_t FLUSH_SIZE = 1 << 20;
+
+    std::FILE* file;
+    std::vector<std::uint8_t> buffer;
+    std::uint64_t previousSeed;
+    bool failed;
+
+    void flush() {
+        if (!buffer.empty() && std::fwrite(buffer.data(), 1, buffer.size(), file) != buffer.size())
+            failed = true;
+        buffer.clear();
+    }
+
+public:
+    RecordWriter() : file(nullptr), previousSeed(0), failed(false) {}
+    ~RecordWriter() { close(); }
+
+    RecordWriter(const RecordWriter&) = delete;
+    RecordWriter& operator=(const RecordWriter&) = delete;
+
+    // Creates the file and writes its header; every game written must be
+    // played under the given rules
+    bool open(const std::string& path, Rules rules = Rules()) {
+        close();
+        file = std::fopen(path.c_str(), "wb");
+        if (!file)
+            return false;
+        RecordHeader header;
+        std::memcpy(header.magic, "KBRECORD", 8);
+        header.version = RECORD_VERSION;
+        header.rules = rules.bits();
+        const std::uint8_t* bytes = reinterpret_cast<const std::uint8_t*>(&header);
+        buffer.assign(bytes, bytes + sizeof(header));
+        previousSeed = 0;
+        failed = false;
+        return true;
+    }
+
+    bool isOpen() const { return file != nullptr; }
+
+    void write(const GameRecord& record) {
+        encodeRecord(record, previousSeed, buffer);
+        if (buffer.size() >= FLUSH_SIZE)
+            flush();
+    }
+
+    // Flushes and closes the file; false if anything failed to write
+    bool close() {
+        if (!file)
+            return !failed;
+        flush();
+        if (std::fclose(file) != 0)
+            failed = true;
+        file = nullptr;
+        return !failed;
+    }
+};
+
+/**
+ * Class Name: RecordReader
+ *
+ * Description:
+ *      Reads a whole record file into memory and decodes games one by one.
+ *      Threads can share the loaded bytes and call decodeRecord() from
+ *      any position()/lastSeed() pair seen while reading.
+ *
+ * Public Methods:
+ *      - bool load(const std::string& path)
+ *      - bool next(GameRecord& record)
+ *      - std::size_t position() const
+ *      - std::uint64_t lastSeed() const
+ *      - const std::vector<std::uint8_t>& data() const
+ *      - Rules rules() const
+ *
+ * Private Members:
+ *      - std::vector<std::uint8_t> bytes
+ *      - std::size_t offset
+ *      - std::uint64_t previousSeed
+ */
+class RecordReader {
+    std::vector<std::uint8_t> bytes;
+    std::size_t offset;
+    std::uint64_t previousSeed;
+    Rules fileRules;
+
+public:
+    RecordReader() : offset(0), previousSeed(0) {}
+
+    // Reads the file and checks its header
+    bool load(const std::string& path) {
+        bytes.clear();
+        std::FILE* file = std::fopen(path.c_str(), "rb");
+        if (!file)
+            return false;
+        std::uint8_t chunk[1 << 16];
+        std::size_t n;
+        while ((n = std::fread(chunk, 1, sizeof(chunk), file)) > 0)
+            bytes.insert(bytes.end(), chunk, chunk + n);
+        std::fclose(file);
+
+        RecordHeader header;
+        if (bytes.size() < sizeof(header))
+            return false;
+        std::memcpy(&header, bytes.data(), sizeof(header));
+        if (std::memcmp(header.magic, "KBRECORD", 8) != 0 || header.version != RECORD_VERSION ||
+            (header.rules & ~Rules::ALL_BITS) != 0)
+            return false;
+        fileRules = Rules::fromBits(header.rules);
+        offset = sizeof(header);
+        previousSeed = 0;
+        return true;
+    }
+
+    // Decodes the next game; false at the end of the file
+    bool next(GameRecord& record) {
+        const std::uint8_t* p = bytes.data() + offset;
+        if (!decodeRecord(p, bytes.data() + bytes.size(), previousSeed, record))
+            return false;
+        offset = p - bytes.data();
+        return true;
+    }
+
+    // Where the next game starts, and the seed its delta is relative to
+    std::size_t position() const { return offset; }
+    std::uint64_t lastSeed() const { return previousSeed; }
+
+    // Rules the games in the file were played under
+    Rules rules() const { return fileRules; }
+
+    // The whole file, header included
+    const std::vector<std::uint8_t>& data() const { return bytes; }
+};
@@ -0,0 +1,199 @@
+/*****************************************************************************
+*
+*  Author:           Jesus Mendoza
+*  Email:            jesus.kyx.mendoza11@gmail.com
+*  Label:            Program 2C - Knucklebones Game
+*  Title:            Game Record Replayer
+*  Course:           CMPS 2143
+*  Semester:         Fall 2024
+*
+*  Description:
+*        Replays every game in a record file through the engine and checks
+*        that each move is legal, each game ends on its last move and the
+*        final scores match the recorded ones. A change to the rules or to
+*        calculateScore() shows up as mismatches, and the first failing
+*        game is printed so it can be inspected, or watched with
+*        ./knucklebones --replay.
+*
+*        The file is read once, cut into chunks of 65,536 games and the
+*        chunks are replayed on every core, under the rules named in the
+*        file's header.
+*
+*  Usage:
+*        ./replay file [--threads n] [--show game]
+*
+*        --show prints the rolls, columns and final grids of one game.
+*
+*  Files:
+*        replay.cpp  : Replayer.
+*        record.hpp  : Record format.
+*
+*****************************************************************************/
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include "record.hpp"
+
+using namespace std;
+
+// Where a chunk of games starts in the file
+struct Checkpoint {
+    size_t offset;
+    uint64_t previousSeed;
+    long long firstGame;
+    long long games;
+};
+
+const char* statusName(ReplayStatus status) {
+    switch (status) {
+    case ReplayStatus::OK:
+        return "ok";
+    case ReplayStatus::ILLEGAL_MOVE:
+        return "illegal move";
+    case ReplayStatus::UNFINISHED:
+        return "unfinished";
+    case ReplayStatus::EXTRA_MOVES:
+        return "moves after the end";
+    case ReplayStatus::SCORE_MISMATCH:
+        return "score mismatch";
+    }
+    return "?";
+}
+
+void printGrid(const Grid& grid) {
+    for (int row = 0; row < 3; ++row) {
+        cout << "    ";
+        for (int col = 0; col < 3; ++col)
+            cout << (grid.at(row, col) ? static_cast<char>('0' + grid.at(row, col)) : '.') << ' ';
+        cout << endl;
+    }
+}
+
+// Prints a game move by move
+void showGame(long long index, const GameRecord& record, Rules rules) {
+    cout << "Game " << index << "  seed " << record.seed << "  moves " << record.moves << endl;
+    Dice dice(record.seed);
+    GameState state(rules);
+    for (int move = 0; move < record.moves; ++move) {
+        int die = dice.roll();
+        cout << "  " << move + 1 << ". Player " << state.sideToMove() + 1 << " rolls " << die << ", column "
+             << record.column(move) + 1 << endl;
+        if (!state.applyMove(record.column(move), die))
+            break;
+    }
+    for (int p = 0; p < 2; ++p) {
+        cout << "  Player " << p + 1 << ": recorded " << static_cast<int>(record.scores[p]) << ", engine "
+             << state.grids[p].calculateScore() << endl;
+        printGrid(state.grids[p]);
+    }
+    cout << "  Replay: " << statusName(replayGame(record, rules)) << endl;
+}
+
+int main(int argc, char* argv[]) {
+    const char* path = nullptr;
+    int threadCount = static_cast<int>(thread::hardware_concurrency());
+    long long show = -1;
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc)
+            threadCount = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--show") == 0 && i + 1 < argc)
+            show = atoll(argv[++i]);
+        else
+            path = argv[i];
+    }
+    if (!path) {
+        cerr << "Usage: ./replay file [--threads n] [--show game]" << endl;
+        return 1;
+    }
+    if (threadCount < 1)
+        threadCount = 1;
+
+    RecordReader reader;
+    if (!reader.load(path)) {
+        cerr << "Error loading record file " << path << endl;
+        return 1;
+    }
+
+    // One pass to find the chunk boundaries (and the game to show)
+    const long long CHUNK = 65536;
+    vector<Checkpoint> chunks;
+    GameRecord record;
+    long long games = 0;
+    auto start = chrono::steady_clock::now();
+    while (true) {
+        if (games % CHUNK == 0)
+            chunks.push_back({reader.position(), reader.lastSeed(), games, 0});
+        if (!reader.next(record))
+            break;
+        if (games == show)
+            showGame(games, record, reader.rules());
+        chunks.back().games++;
+        games++;
+    }
+    if (reader.position() != reader.data().size())
+        cerr << "Warning: " << reader.data().size() - reader.position() << " trailing bytes after game " << games
+             << endl;
+    double scanSeconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    // Replay the chunks on every core
+    atomic<size_t> nextChunk(0);
+    atomic<long long> failures[5] = {};
+    atomic<long long> firstFailure(games);
+    start = chrono::steady_clock::now();
+    vector<thread> workers;
+    for (int t = 0; t < threadCount; ++t) {
+        workers.emplace_back([&] {
+            const uint8_t* end = reader.data().data() + reader.data().size();
+            GameRecord game;
+            for (size_t c; (c = nextChunk++) < chunks.size();) {
+                const uint8_t* p = reader.data().data() + chunks[c].offset;
+                uint64_t previousSeed = chunks[c].previousSeed;
+                for (long long g = 0; g < chunks[c].games; ++g) {
+                    decodeRecord(p, end, previousSeed, game);
+                    ReplayStatus status = replayGame(game, reader.rules());
+                    if (status != ReplayStatus::OK) {
+                        failures[static_cast<int>(status)]++;
+                        long long index = chunks[c].firstGame + g;
+                        long long seen = firstFailure.load();
+                        while (index < seen && !firstFailure.compare_exchange_weak(seen, index)) {
+                        }
+                    }
+                }
+            }
+        });
+    }
+    for (auto& worker : workers)
+        worker.join();
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    long long failed = 0;
+    for (int s = 1; s < 5; ++s)
+        failed += failures[s];
+
+    cout << "Games:        " << games << " (" << reader.data().size() << " bytes, "
+         << (games ? static_cast<double>(reader.data().size() - sizeof(RecordHeader)) / games : 0)
+         << " bytes/game)" << endl;
+    cout << "Rules:        " << (reader.rules().isStandard() ? "standard" : "variant") << " ("
+         << (reader.rules().cancellation ? "cancellation" : "no cancellation") << ", ends when "
+         << (reader.rules().endOnEitherFull ? "either grid is" : "both grids are") << " full)" << endl;
+    cout << "Verified:     " << games - failed << endl;
+    for (int s = 1; s < 5; ++s)
+        if (failures[s] > 0)
+            cout << "  " << statusName(static_cast<ReplayStatus>(s)) << ": " << failures[s] << endl;
+    cout << "Scan:         " << static_cast<long long>(games / scanSeconds) << " games/second" << endl;
+    cout << "Replay:       " << static_cast<long long>(games / seconds) << " games/second on " << threadCount
+         << " threads" << endl;
+
+    if (failed > 0) {
+        cout << "First failure: game " << firstFailure.load() << " (run with --show " << firstFailure.load()
+             << " for details)" << endl;
+        return 2;
+    }
+    return 0;
+}
@@ -0,0 +1,185 @@
+/*****************************************************************************
+*
+*  Author:           Jesus Mendoza
+*  Email:            jesus.kyx.mendoza11@gmail.com
+*  Label:            Program 2C - Knucklebones Game
+*  Title:            Headless Knucklebones Simulation
+*  Course:           CMPS 2143
+*  Semester:         Fall 2024
+*
+*  Description:
+*        Plays a batch of Knucklebones games with no window, both players
+*        picking a random legal column, and reports the results and how
+*        many games per second the engine managed. With --ai, player 2 is
+*        the expectiminimax computer player instead, with --mcts the Monte
+*        Carlo tree search player, and with --solved it plays perfectly
+*        from a table written by solve.cpp.
+*
+*        Every run with the same --seed plays exactly the same games. Each
+*        game rolls its own Dice, seeded from the run seed and the game
+*        number, so with --record every game can be written to a record
+*        file (see record.hpp) and checked later with ./replay.
+*
+*        With --classic the games use the original rules: a placed die
+*        cancels the opponent's matching dice in that column and the game
+*        ends when either grid is full (see Rules in engine.hpp).
+*
+*  Usage:
+*        ./simulate [games] [--seed n] [--ai | --mcts | --solved table]
+*                   [--classic] [--record file]
+*                                        (default 1000000 games, seed 1)
+*
+*        games must be a positive whole number. Any other argument that
+*        is not one of the flags prints this usage and exits with 1.
+*
+*  Files:
+*        simulate.cpp        : Batch driver.
+*        engine.hpp          : Headless rules used by the driver.
+*        expectiminimax.hpp  : Computer player used with --ai.
+*        mcts.hpp            : Computer player used with --mcts.
+*        solver.hpp          : Solved table used with --solved.
+*        record.hpp          : Game records written with --record.
+*
+*****************************************************************************/
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+#include "engine.hpp"
+#include "expectiminimax.hpp"
+#include "mcts.hpp"
+#include "record.hpp"
+#include "solver.hpp"
+
+using namespace std;
+
+// Picks a random column that still has room for the side to move
+int randomLegalColumn(const GameState& state, Dice& dice) {
+    int legal[3];
+    int count = 0;
+    for (int col = 0; col < 3; ++col) {
+        if (state.isLegal(col))
+            legal[count++] = col;
+    }
+    return legal[dice.below(count)];
+}
+
+int main(int argc, char* argv[]) {
+    long long games = 1000000;
+    unsigned long long seed = 1;
+    bool useAI = false;
+    bool useMcts = false;
+    Rules rules;
+    string recordPath;
+    SolvedTable table;
+    RecordWriter writer;
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--ai") == 0) {
+            useAI = true;
+        } else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            seed = strtoull(argv[++i], nullptr, 10);
+        } else if (strcmp(argv[i], "--mcts") == 0) {
+            useMcts = true;
+        } else if (strcmp(argv[i], "--solved") == 0 && i + 1 < argc) {
+            if (!table.load(argv[++i])) {
+                cerr << "Error loading solved table " << argv[i] << endl;
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--classic") == 0) {
+            rules = Rules::classic();
+        } else if (strcmp(argv[i], "--record") == 0 && i + 1 < argc) {
+            recordPath = argv[++i];
+        } else if (argv[i][0] != '\0' && strspn(argv[i], "0123456789") == strlen(argv[i]) && atoll(argv[i]) > 0) {
+            games = atoll(argv[i]);
+        } else {
+            cerr << "Usage: ./simulate [games] [--seed n] [--ai | --mcts | --solved table] [--classic] [--record file]"
+                 << endl;
+            return 1;
+        }
+    }
+
+    if (table.isLoaded() && !rules.isStandard()) {
+        cerr << "Solved tables only hold for the standard rules" << endl;
+        return 1;
+    }
+    if (!recordPath.empty() && !writer.open(recordPath, rules)) {
+        cerr << "Error creating record file " << recordPath << endl;
+        return 1;
+    }
+
+    ExpectiminimaxAI ai(2.0);
+    MctsAI mcts(10.0, 0, 0, 0.7, seed);
+    long long mctsPlayouts = 0;
+    double mctsMilliseconds = 0;
+    Dice dice(seed);  // Random players' choices
+    GameState state(rules);
+    GameRecord record;
+    long long wins1 = 0, wins2 = 0, draws = 0;
+    long long moves = 0, tooLong = 0;
+
+    auto start = chrono::steady_clock::now();
+    for (long long g = 0; g < games; ++g) {
+        // Consecutive seeds, so a record spends one byte on the seed
+        uint64_t gameSeed = (static_cast<uint64_t>(seed) << 32) + static_cast<uint64_t>(g);
+        Dice rolls(gameSeed);
+        record.clear(gameSeed);
+
+        state.reset();
+        while (!state.isTerminal()) {
+            int die = rolls.roll();
+            int col;
+            if (state.sideToMove() == 0)
+                col = randomLegalColumn(state, dice);
+            else if (table.isLoaded())
+                col = table.bestColumn(state, die);
+            else if (useAI)
+                col = ai.chooseColumn(state, die);
+            else if (useMcts) {
+                col = mcts.chooseColumn(state, die);
+                mctsPlayouts += mcts.lastStats().playouts;
+                mctsMilliseconds += mcts.lastStats().milliseconds;
+            }
+            else
+                col = randomLegalColumn(state, dice);
+            state.applyMove(col, die);
+            record.addMove(col);
+        }
+        moves += state.turn;
+        if (state.turn > MAX_RECORD_MOVES)
+            tooLong++;  // Cannot be recorded; only possible with cancellation
+        else if (writer.isOpen()) {
+            record.finish(state);
+            writer.write(record);
+        }
+
+        GameScores s = state.scores();
+        if (s.player1 > s.player2)
+            wins1++;
+        else if (s.player2 > s.player1)
+            wins2++;
+        else
+            draws++;
+    }
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    if (!writer.close()) {
+        cerr << "Error writing the record file" << endl;
+        return 1;
+    }
+
+    cout << "Games:        " << games << endl;
+    cout << "Player 1 won: " << wins1 << endl;
+    cout << "Player 2 won: " << wins2 << endl;
+    cout << "Draws:        " << draws << endl;
+    cout << "Moves/game:   " << static_cast<double>(moves) / games << endl;
+    if (!recordPath.empty() && tooLong > 0)
+        cout << "Not recorded: " << tooLong << " games over " << MAX_RECORD_MOVES << " moves" << endl;
+    cout << "Games/second: " << static_cast<long long>(games / seconds) << endl;
+    if (useMcts) {
+        cout << "MCTS threads: " << mcts.lastStats().threads << endl;
+        cout << "Playouts/sec: " << static_cast<long long>(mctsPlayouts * 1000.0 / mctsMilliseconds) << endl;
+    }
+    return 0;
+}
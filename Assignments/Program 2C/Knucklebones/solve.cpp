@@ -0,0 +1,86 @@
+/*****************************************************************************
+*
+*  Author:           Jesus Mendoza
+*  Email:            jesus.kyx.mendoza11@gmail.com
+*  Label:            Program 2C - Knucklebones Game
+*  Title:            Knucklebones Solver
+*  Course:           CMPS 2143
+*  Semester:         Fall 2024
+*
+*  Description:
+*        Computes the expected final score under perfect play for every
+*        reachable grid and writes the table read by SolvedTable.
+*
+*        Only one grid per canonical class is solved. Placing a die always
+*        gives a higher canonical rank (see canonical.hpp), so walking the
+*        ranks from the last to the first solves each grid after all of its
+*        successors, in a single pass with no recursion (retrograde
+*        analysis).
+*
+*  Usage:
+*        ./solve [output]      (default knucklebones.solved)
+*
+*  Files:
+*        solve.cpp      : Offline solver.
+*        solver.hpp     : Table layout and the run-time reader.
+*        canonical.hpp  : Canonical ranking of grids.
+*
+*****************************************************************************/
+
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <vector>
+
+#include "solver.hpp"
+
+using namespace std;
+
+int main(int argc, char* argv[]) {
+    string path = argc > 1 ? argv[1] : "knucklebones.solved";
+
+    auto start = chrono::steady_clock::now();
+    vector<float> values(CANONICAL_GRIDS);
+    for (long long index = CANONICAL_GRIDS - 1; index >= 0; --index) {
+        Grid grid = unrankCanonical(static_cast<uint32_t>(index));
+
+        if (grid.isFull()) {
+            values[index] = static_cast<float>(grid.score());
+            continue;
+        }
+
+        // Average over the roll of the best placement for each die
+        double sum = 0;
+        for (int die = 1; die <= 6; ++die) {
+            float best = 0;
+            for (int col = 0; col < 3; ++col) {
+                Grid next = grid;
+                if (next.placeDice(col, die) && values[solvedIndex(next)] > best)
+                    best = values[solvedIndex(next)];
+            }
+            sum += best;
+        }
+        values[index] = static_cast<float>(sum / 6);
+    }
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    SolvedHeader header = {{'K', 'B', 'S', 'O', 'L', 'V', 'E', 'D'}, SOLVED_VERSION,
+                           COLUMN_MULTISETS, CANONICAL_GRIDS};
+    FILE* file = fopen(path.c_str(), "wb");
+    if (!file) {
+        cerr << "Error opening " << path << endl;
+        return 1;
+    }
+    bool ok = fwrite(&header, sizeof(header), 1, file) == 1 &&
+              fwrite(values.data(), sizeof(float), values.size(), file) == values.size();
+    ok = fclose(file) == 0 && ok;
+    if (!ok) {
+        cerr << "Error writing " << path << endl;
+        return 1;
+    }
+
+    cout << "Solved " << CANONICAL_GRIDS << " canonical grids in " << seconds << " s" << endl;
+    cout << "Expected score of an empty grid: " << values[0] << endl;
+    cout << "Wrote " << path << endl;
+    return 0;
+}
@@ -0,0 +1,187 @@
+/*****************************************************************************
+*
+*  Author:           Jesus Mendoza
+*  Email:            jesus.kyx.mendoza11@gmail.com
+*  Label:            Program 2C - Knucklebones Game
+*  Title:            Solved Knucklebones Table
+*  Course:           CMPS 2143
+*  Semester:         Fall 2024
+*
+*  Description:
+*        Exact values for every reachable grid, computed offline by solve.cpp
+*        and memory-mapped at run time so a perfect player answers with a
+*        few table loads and no start-up work.
+*
+*        Under the standard rules the two grids never interact: a player's
+*        choices and rolls only ever change their own grid. The expected
+*        final score difference therefore splits into one expected score
+*        per grid, and the best move for a grid is the one that maximizes
+*        that grid's expected final score. The table stores, for every
+*        grid, its expected final score under perfect play before the next
+*        roll; the value of a full game state is the difference of the two
+*        grids' entries. With cancellation (see Rules in engine.hpp) the
+*        grids interact and the table does not apply.
+*
+*        Grids are indexed by their canonical rank, so every class of
+*        equivalent grids shares one entry: 102,340 floats (400 KB), small
+*        enough to stay in cache.
+*
+*  Usage:
+*        SolvedTable table;
+*        if (table.load("knucklebones.solved")) {
+*            int col = table.bestColumn(state, die);
+*            double margin = table.value(state); // Player 1's expected lead
+*        }
+*
+*****************************************************************************/
+
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "canonical.hpp"
+#include "engine.hpp"
+
+// Position of a grid in the solved table. Grids that play alike share
+// one entry (see canonical.hpp).
+inline std::uint32_t solvedIndex(const Grid& grid) {
+    return canonicalRank(grid);
+}
+
+// Layout of the file written by solve.cpp: this header, then one float
+// per grid in solvedIndex() order
+struct SolvedHeader {
+    char magic[8];            // "KBSOLVED"
+    std::uint32_t version;    // SOLVED_VERSION
+    std::uint32_t multisets;  // COLUMN_MULTISETS
+    std::uint64_t entries;    // CANONICAL_GRIDS
+};
+
+constexpr std::uint32_t SOLVED_VERSION = 2;
+
+/**
+ * Class Name: SolvedTable
+ *
+ * Description:
+ *      Read-only view of a solved table file. The file is mapped into
+ *      memory rather than read, so loading costs one system call and pages
+ *      are pulled in only when a position needs them.
+ *
+ * Public Methods:
+ *      - SolvedTable()
+ *      - ~SolvedTable()
+ *      - bool load(const std::string& path)
+ *      - bool isLoaded() const
+ *      - float expectedScore(const Grid& grid) const
+ *      - double value(const GameState& state) const
+ *      - int bestColumn(const GameState& state, int die) const
+ *
+ * Private Members:
+ *      - void* mapping
+ *      - std::size_t mappingSize
+ *      - const float* values
+ *
+ * Usage:
+ *      SolvedTable table;
+ *      table.load("knucklebones.solved");
+ *      int col = table.bestColumn(state, die);
+ */
+class SolvedTable {
+    void* mapping;
+    std::size_t mappingSize;
+    const float* values;
+
+    void unload() {
+        if (mapping)
+            munmap(mapping, mappingSize);
+        mapping = nullptr;
+        mappingSize = 0;
+        values = nullptr;
+    }
+
+public:
+    SolvedTable() : mapping(nullptr), mappingSize(0), values(nullptr) {}
+    ~SolvedTable() { unload(); }
+
+    SolvedTable(const SolvedTable&) = delete;
+    SolvedTable& operator=(const SolvedTable&) = delete;
+
+    /**
+     * Public : load
+     *
+     * Description:
+     *      Maps a table file written by solve.cpp and checks its header.
+     *
+     * Params:
+     *      - const std::string& path : Location of the table file.
+     *
+     * Returns:
+     *      - bool : false if the file is missing or not a solved table.
+     */
+    bool load(const std::string& path) {
+        unload();
+
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+            return false;
+
+        struct stat info;
+        std::size_t expected = sizeof(SolvedHeader) + CANONICAL_GRIDS * sizeof(float);
+        if (fstat(fd, &info) != 0 || static_cast<std::size_t>(info.st_size) != expected) {
+            ::close(fd);
+            return false;
+        }
+
+        void* data = mmap(nullptr, expected, PROT_READ, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (data == MAP_FAILED)
+            return false;
+
+        const SolvedHeader* header = static_cast<const SolvedHeader*>(data);
+        if (std::memcmp(header->magic, "KBSOLVED", 8) != 0 || header->version != SOLVED_VERSION ||
+            header->multisets != COLUMN_MULTISETS || header->entries != CANONICAL_GRIDS) {
+            munmap(data, expected);
+            return false;
+        }
+
+        mapping = data;
+        mappingSize = expected;
+        values = reinterpret_cast<const float*>(header + 1);
+        return true;
+    }
+
+    bool isLoaded() const { return values != nullptr; }
+
+    // Expected final score of a grid under perfect play, before its next roll
+    float expectedScore(const Grid& grid) const { return values[solvedIndex(grid)]; }
+
+    // Expected final score difference (player 1 minus player 2)
+    double value(const GameState& state) const {
+        return static_cast<double>(expectedScore(state.grids[0])) - expectedScore(state.grids[1]);
+    }
+
+    // The column that maximizes the mover's expected final score
+    int bestColumn(const GameState& state, int die) const {
+        const Grid& grid = state.grids[state.sideToMove()];
+        int best = -1;
+        float bestValue = 0;
+        for (int col = 0; col < 3; ++col) {
+            Grid next = grid;
+            if (!next.placeDice(col, die))
+                continue;
+            float v = expectedScore(next);
+            if (best < 0 || v > bestValue) {
+                best = col;
+                bestValue = v;
+            }
+        }
+        return best;
+    }
+};
@@ -0,0 +1,190 @@
+/*****************************************************************************
+*
+*  Author:           Jesus Mendoza
+*  Email:            jesus.kyx.mendoza11@gmail.com
+*  Label:            Program 2C - Knucklebones Game
+*  Title:            Pluggable Player Strategies
+*  Course:           CMPS 2143
+*  Semester:         Fall 2024
+*
+*  Description:
+*        One interface for every way of choosing a column, so tournaments
+*        and simulations can pit any two players against each other. A
+*        strategy is built from a short text spec:
+*
+*            random             Any legal column
+*            greedy             Column that gains the most on the opponent now
+*            table              Column with the best expected value from the
+*                               column tables in column_values.hpp
+*            emm[:depth]        Expectiminimax to a fixed depth (default 2)
+*            mcts[:playouts]    Single-threaded MCTS (default 200 playouts)
+*            mcts-table[:playouts]  MCTS with table-guided playouts
+*            solved:<table>     Perfect play from a solved table
+*
+*        Strategies keep state (search tables, trees, dice), so every
+*        thread makes its own with makeStrategy().
+*
+*  Usage:
+*        std::unique_ptr<Strategy> player = makeStrategy("emm:3", seed);
+*        int col = player->chooseColumn(state, die);
+*
+*****************************************************************************/
+
+#pragma once
+
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <string>
+
+#include "column_values.hpp"
+#include "engine.hpp"
+#include "expectiminimax.hpp"
+#include "mcts.hpp"
+#include "solver.hpp"
+
+/**
+ * Class Name: Strategy
+ *
+ * Description:
+ *      A player that picks a column for a rolled die.
+ *
+ * Public Methods:
+ *      - virtual int chooseColumn(const GameState& state, int die)
+ *      - const std::string& getName() const
+ */
+class Strategy {
+    std::string name;
+
+public:
+    explicit Strategy(const std::string& name) : name(name) {}
+    virtual ~Strategy() {}
+
+    // Returns a legal column (0-2) for the side to move
+    virtual int chooseColumn(const GameState& state, int die) = 0;
+
+    const std::string& getName() const { return name; }
+};
+
+// Any legal column, uniformly
+class RandomStrategy : public Strategy {
+    Dice dice;
+
+public:
+    RandomStrategy(const std::string& name, std::uint64_t seed) : Strategy(name), dice(seed) {}
+
+    int chooseColumn(const GameState& state, int) override {
+        int legal[3];
+        int count = 0;
+        for (int col = 0; col < 3; ++col)
+            if (state.isLegal(col))
+                legal[count++] = col;
+        return legal[dice.below(count)];
+    }
+};
+
+// The column that gives the best score difference right now. Under the
+// standard rules that is the column that raises the mover's score the
+// most; with cancellation, dice taken from the opponent count as well.
+class GreedyStrategy : public Strategy {
+public:
+    explicit GreedyStrategy(const std::string& name) : Strategy(name) {}
+
+    int chooseColumn(const GameState& state, int die) override {
+        GameState position = state;
+        int side = state.sideToMove();
+        int best = -1;
+        int bestMargin = 0;
+        for (int col = 0; col < 3; ++col) {
+            MoveUndo undo;
+            if (!position.makeMove(col, die, undo))
+                continue;
+            int margin = position.grids[side].score() - position.grids[1 - side].score();
+            if (best < 0 || margin > bestMargin) {
+                bestMargin = margin;
+                best = col;
+            }
+            position.unmakeMove(undo);
+        }
+        return best;
+    }
+};
+
+// Column value tables only, no search
+class TableStrategy : public Strategy {
+public:
+    explicit TableStrategy(const std::string& name) : Strategy(name) {}
+
+    int chooseColumn(const GameState& state, int die) override { return tableColumn(state, die); }
+};
+
+// Fixed-depth expectiminimax, so results do not depend on machine speed
+class ExpectiminimaxStrategy : public Strategy {
+    ExpectiminimaxAI ai;
+
+public:
+    ExpectiminimaxStrategy(const std::string& name, int depth) : Strategy(name), ai(0, depth, 18) {}
+
+    int chooseColumn(const GameState& state, int die) override { return ai.chooseColumn(state, die); }
+};
+
+// Single-threaded MCTS with a fixed number of playouts per move
+class MctsStrategy : public Strategy {
+    MctsAI ai;
+
+public:
+    MctsStrategy(const std::string& name, long long playouts, std::uint64_t seed, bool tablePlayouts = false)
+        : Strategy(name), ai(0, 1, playouts, 0.7, seed, tablePlayouts) {}
+
+    int chooseColumn(const GameState& state, int die) override { return ai.chooseColumn(state, die); }
+};
+
+// Perfect play from a memory-mapped solved table (standard rules only)
+class SolvedStrategy : public Strategy {
+    SolvedTable table;
+
+public:
+    explicit SolvedStrategy(const std::string& name) : Strategy(name) {}
+
+    bool load(const std::string& path) { return table.load(path); }
+
+    int chooseColumn(const GameState& state, int die) override { return table.bestColumn(state, die); }
+};
+
+/**
+ * Function Name: makeStrategy
+ *
+ * Description:
+ *      Builds a strategy from a spec such as "greedy" or "mcts:500".
+ *
+ * Params:
+ *      - const std::string& spec : Strategy name with an optional ":parameter".
+ *      - std::uint64_t seed : Seed for strategies that use randomness.
+ *
+ * Returns:
+ *      - std::unique_ptr<Strategy> : The new strategy, or null if the spec
+ *        is unknown or its table cannot be loaded.
+ */
+inline std::unique_ptr<Strategy> makeStrategy(const std::string& spec, std::uint64_t seed) {
+    std::string kind = spec.substr(0, spec.find(':'));
+    std::string param = spec.find(':') == std::string::npos ? "" : spec.substr(spec.find(':') + 1);
+
+    if (kind == "random")
+        return std::make_unique<RandomStrategy>(spec, seed);
+    if (kind == "greedy")
+        return std::make_unique<GreedyStrategy>(spec);
+    if (kind == "table")
+        return std::make_unique<TableStrategy>(spec);
+    if (kind == "emm")
+        return std::make_unique<ExpectiminimaxStrategy>(spec, param.empty() ? 2 : atoi(param.c_str()));
+    if (kind == "mcts")
+        return std::make_unique<MctsStrategy>(spec, param.empty() ? 200 : atoll(param.c_str()), seed);
+    if (kind == "mcts-table")
+        return std::make_unique<MctsStrategy>(spec, param.empty() ? 200 : atoll(param.c_str()), seed, true);
+    if (kind == "solved") {
+        auto strategy = std::make_unique<SolvedStrategy>(spec);
+        if (strategy->load(param))
+            return strategy;
+    }
+    return nullptr;
+}
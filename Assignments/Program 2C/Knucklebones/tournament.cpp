@@ -0,0 +1,351 @@
+/*****************************************************************************
+*
+*  Author:           Jesus Mendoza
+*  Email:            jesus.kyx.mendoza11@gmail.com
+*  Label:            Program 2C - Knucklebones Game
+*  Title:            Knucklebones Strategy Tournament
+*  Course:           CMPS 2143
+*  Semester:         Fall 2024
+*
+*  Description:
+*        Plays every pair of strategies against each other (round robin)
+*        and reports win and draw rates with 95% confidence intervals, the
+*        score distribution of each strategy and the overall games/second.
+*
+*        Games are cut into chunks and spread over a work-stealing thread
+*        pool: each worker takes chunks from its own queue and, once that
+*        runs dry, steals from the others, so slow strategies do not leave
+*        cores idle. Game dice are seeded from the run seed and the game
+*        number, and both seatings of a pairing are played with the same
+*        dice, so the luck of the rolls cancels out. Strategies that use
+*        randomness get their own stream per worker. Strategies also keep
+*        per-worker state (dice streams, search tables), so results can move
+*        slightly, within the confidence intervals, with the thread count.
+*
+*  Usage:
+*        ./tournament [--games n] [--threads n] [--seed n] [--classic] [strategy ...]
+*
+*        --games is the number of games per pairing (default 100000, at
+*        least 1).
+*        --classic plays with cancellation, ending when either grid is
+*        full (see Rules in engine.hpp); solved tables do not apply then.
+*        Strategies use the specs from strategies.hpp; the default field
+*        is random, greedy, emm:1 and mcts:100.
+*
+*  Files:
+*        tournament.cpp  : Tournament driver and thread pool.
+*        strategies.hpp  : Strategies that can be entered.
+*
+*****************************************************************************/
+
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "strategies.hpp"
+
+using namespace std;
+
+// A slice of the games of one pairing
+struct Task {
+    int pairing;
+    long long firstGame;
+    long long games;
+};
+
+/**
+ * Class Name: WorkStealingPool
+ *
+ * Description:
+ *      Runs a fixed list of tasks on several threads. Tasks are dealt out
+ *      round robin; a worker takes from the back of its own queue and steals
+ *      from the front of another worker's queue when its own is empty.
+ *
+ * Public Methods:
+ *      - WorkStealingPool(int workers)
+ *      - void add(const Task& task)
+ *      - template <class F> void run(F work)
+ *
+ * Private Members:
+ *      - std::vector<Queue> queues
+ *      - int next
+ */
+class WorkStealingPool {
+    struct Queue {
+        mutex lock;
+        deque<Task> tasks;
+    };
+
+    vector<unique_ptr<Queue>> queues;
+    int next;
+
+    bool take(int worker, Task& task) {
+        Queue& own = *queues[worker];
+        {
+            lock_guard<mutex> guard(own.lock);
+            if (!own.tasks.empty()) {
+                task = own.tasks.back();
+                own.tasks.pop_back();
+                return true;
+            }
+        }
+        for (size_t i = 1; i < queues.size(); ++i) {
+            Queue& victim = *queues[(worker + i) % queues.size()];
+            lock_guard<mutex> guard(victim.lock);
+            if (!victim.tasks.empty()) {
+                task = victim.tasks.front();
+                victim.tasks.pop_front();
+                return true;
+            }
+        }
+        return false;
+    }
+
+public:
+    explicit WorkStealingPool(int workers) : next(0) {
+        for (int i = 0; i < workers; ++i)
+            queues.push_back(make_unique<Queue>());
+    }
+
+    void add(const Task& task) {
+        queues[next]->tasks.push_back(task);
+        next = (next + 1) % queues.size();
+    }
+
+    // Calls work(worker, task) for every task and returns when all are done
+    template <class F>
+    void run(F work) {
+        vector<thread> threads;
+        for (size_t w = 0; w < queues.size(); ++w) {
+            threads.emplace_back([this, w, &work] {
+                Task task;
+                while (take(static_cast<int>(w), task))
+                    work(static_cast<int>(w), task);
+            });
+        }
+        for (auto& t : threads)
+            t.join();
+    }
+};
+
+// Results of one pairing, or of one strategy's scores
+struct PairingResult {
+    long long winsA = 0, winsB = 0, draws = 0;
+};
+
+struct ScoreStats {
+    long long histogram[163] = {0};  // A grid scores 0 to 162
+
+    void add(int score) { histogram[score]++; }
+
+    void merge(const ScoreStats& other) {
+        for (int i = 0; i < 163; ++i)
+            histogram[i] += other.histogram[i];
+    }
+};
+
+// 95% Wilson score interval for a proportion, [0, 1] if there were no trials
+void wilson(long long successes, long long trials, double& low, double& high) {
+    if (trials <= 0) {
+        low = 0;
+        high = 1;
+        return;
+    }
+    const double z = 1.96;
+    double n = static_cast<double>(trials);
+    double p = successes / n;
+    double center = (p + z * z / (2 * n)) / (1 + z * z / n);
+    double margin = z * sqrt(p * (1 - p) / n + z * z / (4 * n * n)) / (1 + z * z / n);
+    low = center - margin;
+    high = center + margin;
+}
+
+// Value below which the given fraction of scores fall
+int percentile(const ScoreStats& stats, long long total, double fraction) {
+    long long target = static_cast<long long>(fraction * (total - 1));
+    long long seen = 0;
+    for (int score = 0; score < 163; ++score) {
+        seen += stats.histogram[score];
+        if (seen > target)
+            return score;
+    }
+    return 162;
+}
+
+int main(int argc, char* argv[]) {
+    long long gamesPerPairing = 100000;
+    int threadCount = static_cast<int>(thread::hardware_concurrency());
+    unsigned long long seed = 1;
+    Rules rules;
+    vector<string> specs;
+
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--games") == 0 && i + 1 < argc)
+            gamesPerPairing = atoll(argv[++i]);
+        else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc)
+            threadCount = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc)
+            seed = strtoull(argv[++i], nullptr, 10);
+        else if (strcmp(argv[i], "--classic") == 0)
+            rules = Rules::classic();
+        else
+            specs.push_back(argv[i]);
+    }
+    if (specs.empty())
+        specs = {"random", "greedy", "emm:1", "mcts:100"};
+    if (threadCount < 1)
+        threadCount = 1;
+    if (gamesPerPairing < 1) {
+        cerr << "The number of games must be positive" << endl;
+        return 1;
+    }
+    if (specs.size() < 2) {
+        cerr << "A tournament needs at least two strategies" << endl;
+        return 1;
+    }
+    for (const string& spec : specs) {
+        if (!makeStrategy(spec, 0)) {
+            cerr << "Unknown strategy or missing table: " << spec << endl;
+            return 1;
+        }
+        if (!rules.isStandard() && spec.rfind("solved", 0) == 0) {
+            cerr << "Solved tables only hold for the standard rules: " << spec << endl;
+            return 1;
+        }
+    }
+
+    // Every unordered pair of strategies
+    vector<pair<int, int>> pairings;
+    for (size_t a = 0; a < specs.size(); ++a)
+        for (size_t b = a + 1; b < specs.size(); ++b)
+            pairings.push_back({static_cast<int>(a), static_cast<int>(b)});
+
+    // Chunks small enough to balance, large enough to keep overhead low
+    const long long CHUNK = 256;
+    WorkStealingPool pool(threadCount);
+    for (size_t p = 0; p < pairings.size(); ++p)
+        for (long long first = 0; first < gamesPerPairing; first += CHUNK)
+            pool.add({static_cast<int>(p), first, min(CHUNK, gamesPerPairing - first)});
+
+    // Per-worker strategies, dice streams and results, merged at the end
+    struct Worker {
+        vector<unique_ptr<Strategy>> strategies;
+        vector<PairingResult> results;
+        vector<ScoreStats> scores;
+    };
+    vector<Worker> workers(threadCount);
+    Dice streams(seed);
+    for (Worker& worker : workers) {
+        streams.jump();
+        for (const string& spec : specs)
+            worker.strategies.push_back(makeStrategy(spec, streams.next()));
+        worker.results.resize(pairings.size());
+        worker.scores.resize(specs.size());
+    }
+
+    atomic<long long> gamesPlayed(0);
+    auto start = chrono::steady_clock::now();
+    pool.run([&](int w, const Task& task) {
+        Worker& worker = workers[w];
+        int a = pairings[task.pairing].first;
+        int b = pairings[task.pairing].second;
+        PairingResult& result = worker.results[task.pairing];
+
+        for (long long g = task.firstGame; g < task.firstGame + task.games; ++g) {
+            // Same dice for both seatings of this game number
+            uint64_t mix = seed ^ (static_cast<uint64_t>(task.pairing) << 40) ^ static_cast<uint64_t>(g);
+            uint64_t gameSeed = splitmix64(mix);
+
+            for (int seating = 0; seating < 2; ++seating) {
+                int first = seating == 0 ? a : b;
+                int second = seating == 0 ? b : a;
+                Strategy* players[2] = {worker.strategies[first].get(), worker.strategies[second].get()};
+
+                Dice dice(gameSeed);
+                GameState state(rules);
+                while (!state.isTerminal()) {
+                    int die = dice.roll();
+                    state.applyMove(players[state.sideToMove()]->chooseColumn(state, die), die);
+                }
+
+                GameScores s = state.scores();
+                int scoreA = seating == 0 ? s.player1 : s.player2;
+                int scoreB = seating == 0 ? s.player2 : s.player1;
+                worker.scores[a].add(scoreA);
+                worker.scores[b].add(scoreB);
+                if (scoreA > scoreB)
+                    result.winsA++;
+                else if (scoreB > scoreA)
+                    result.winsB++;
+                else
+                    result.draws++;
+            }
+        }
+        gamesPlayed += 2 * task.games;
+    });
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    vector<PairingResult> results(pairings.size());
+    vector<ScoreStats> scores(specs.size());
+    for (const Worker& worker : workers) {
+        for (size_t p = 0; p < pairings.size(); ++p) {
+            results[p].winsA += worker.results[p].winsA;
+            results[p].winsB += worker.results[p].winsB;
+            results[p].draws += worker.results[p].draws;
+        }
+        for (size_t i = 0; i < specs.size(); ++i)
+            scores[i].merge(worker.scores[i]);
+    }
+
+    cout << fixed << setprecision(4);
+    cout << "Pairings (" << 2 * gamesPerPairing << " games each, both seatings, 95% CI)" << endl;
+    for (size_t p = 0; p < pairings.size(); ++p) {
+        const PairingResult& r = results[p];
+        long long total = r.winsA + r.winsB + r.draws;
+        double low, high, drawLow, drawHigh;
+        wilson(r.winsA, total, low, high);
+        wilson(r.draws, total, drawLow, drawHigh);
+        double games = static_cast<double>(max(total, 1LL));
+        cout << "  " << setw(12) << specs[pairings[p].first] << " vs " << setw(12) << left
+             << specs[pairings[p].second] << right
+             << "  win " << r.winsA / games << " [" << low << ", " << high << "]"
+             << "  loss " << r.winsB / games
+             << "  draw " << r.draws / games << " [" << drawLow << ", " << drawHigh << "]"
+             << endl;
+    }
+
+    cout << setprecision(2) << "Scores" << endl;
+    for (size_t i = 0; i < specs.size(); ++i) {
+        long long n = 0;
+        double sum = 0, sumSquares = 0;
+        for (int score = 0; score < 163; ++score) {
+            n += scores[i].histogram[score];
+            sum += static_cast<double>(score) * scores[i].histogram[score];
+            sumSquares += static_cast<double>(score) * score * scores[i].histogram[score];
+        }
+        if (n == 0) {
+            cout << "  " << setw(12) << specs[i] << "  no games" << endl;
+            continue;
+        }
+        double mean = sum / n;
+        double stddev = sqrt(max(0.0, sumSquares / n - mean * mean));
+        cout << "  " << setw(12) << specs[i] << "  mean " << mean << "  sd " << stddev
+             << "  p5 " << percentile(scores[i], n, 0.05) << "  p50 " << percentile(scores[i], n, 0.5)
+             << "  p95 " << percentile(scores[i], n, 0.95) << endl;
+    }
+
+    cout << setprecision(0) << "Games: " << gamesPlayed.load() << " on " << threadCount << " threads in "
+         << setprecision(2) << seconds << " s (" << setprecision(0) << gamesPlayed.load() / seconds
+         << " games/second)" << endl;
+    return 0;
+}